@@ -0,0 +1,231 @@
+#include "./Headers/Audio.h"
+#include "./Headers/Assets.h"
+
+/**************************/
+/***** STATIC MEMBERS *****/
+/**************************/
+
+// Base pitch and volume of each sound, in SOUND_NAMES order
+static constexpr double EFFECT_PITCH[] = {COIN_PITCH, JUMP_PITCH, BOUNCE_PITCH, DEATH_PITCH, WIN_PITCH};
+static constexpr double EFFECT_VOL[] = {COIN_VOL, JUMP_VOL, BOUNCE_VOL, DEATH_VOL, WIN_VOL};
+static_assert(std::extent<decltype(EFFECT_PITCH)>::value == std::extent<decltype(SOUND_NAMES)>::value
+           && std::extent<decltype(EFFECT_VOL)>::value == std::extent<decltype(SOUND_NAMES)>::value,
+              "Every sound needs a pitch and volume");
+
+// Sounds that drop in pitch in low gravity
+static constexpr SoundEventType LOWGRAVITY_EFFECTS = Game::SoundEvents::PlayJump | Game::SoundEvents::PlayBounce;
+
+// False until the sound has finished loading
+bool Audio::SetupEffect(Effect& effect, const std::string& name, double volume)
+{
+    const sf::SoundBuffer* buf = Assets::Get().getSound(name);
+    if(buf == nullptr) return false;
+
+    for(sf::Sound& voice : effect.voices)
+    {
+        voice.setBuffer(*buf);
+        voice.setVolume(volume);
+        voice.setLoop(false);
+    }
+    return true;
+}
+
+// Takes a voice that's done, or cuts off the one that started first
+void Audio::Effect::play()
+{
+    IntType voice = next;
+    for(IntType i = 0; i < SOUND_VOICES; ++i)
+    {
+        const IntType v = (next + i) % SOUND_VOICES;
+        if(voices[v].getStatus() == sf::Sound::Stopped) { voice = v; break; }
+    }
+
+    voices[voice].play();
+    next = (voice + 1) % SOUND_VOICES;
+}
+
+void Audio::Effect::setPitch(double inPitch)
+{
+    if(inPitch == pitch) return;
+
+    pitch = inPitch;
+    for(sf::Sound& voice : voices) voice.setPitch(pitch);
+}
+
+/****************************/
+/***** GAME THREAD SIDE *****/
+/****************************/
+
+Audio::Audio()
+{
+    // Doesn't wait, the audio thread picks each sound up once it's ready
+    Assets::Get().preload();
+    thread = std::thread(&Audio::run, this);
+}
+
+Audio::~Audio()
+{
+    running = false;
+    wake();
+    thread.join();
+}
+
+bool Audio::isLoaded() const
+{
+    return loaded;
+}
+
+std::uintmax_t Audio::getDroppedCommands() const
+{
+    return droppedCommands;
+}
+
+bool Audio::send(Command command, SoundEventType value)
+{
+    if(queue.push({command, value}))
+    {
+        wake();
+        return true;
+    }
+
+    ++droppedCommands;
+    return false;
+}
+
+// Taking the lock means the audio thread is either waiting or hasn't
+// checked yet, so the signal can't land in between and be missed
+void Audio::wake()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        woken = true;
+    }
+    wakeSignal.notify_one();
+}
+
+void Audio::update(const Game& game)
+{
+    PROFILE_SCOPE("audio");
+    const SoundEventType events = game.getSoundEvents();
+    if(events != Game::SoundEvents::NoSound) send(Command::Events, events);
+
+    // Only sent when it changes, a dropped one is tried again next tick
+    const bool low = game.getLowGravity();
+    if(low != sentLowGravity && send(Command::LowGravity, low)) sentLowGravity = low;
+}
+
+void Audio::setFocus(bool inFocus)
+{
+    send(Command::Focus, inFocus);
+}
+
+void Audio::setEditor(bool inEditor)
+{
+    send(Command::Editor, inEditor);
+}
+
+/*****************************/
+/***** AUDIO THREAD SIDE *****/
+/*****************************/
+
+void Audio::run()
+{
+    while(running)
+    {
+        if(!loaded) attach();
+
+        Message message;
+        while(queue.pop(message)) apply(message);
+        mix();
+
+        // Sleeps until the game sends something, only checking back
+        // on its own while sounds are loading or voices are playing
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        const auto sent = [this] { return woken || !running; };
+        if(loaded && !isPlaying()) wakeSignal.wait(lock, sent);
+        else wakeSignal.wait_for(lock, AUDIO_IDLE_TIME, sent);
+        woken = false;
+    }
+}
+
+bool Audio::isPlaying() const
+{
+    for(const Effect& effect : effects)
+        for(const sf::Sound& voice : effect.voices)
+            if(voice.getStatus() == sf::Sound::Playing) return true;
+    return false;
+}
+
+void Audio::attach()
+{
+    for(std::size_t i = 0; i < EFFECT_COUNT; ++i)
+        if(!effects[i].attached) effects[i].attached = SetupEffect(effects[i], SOUND_NAMES[i], EFFECT_VOL[i]);
+
+    if(overworldMusic == nullptr)
+    {
+        overworldMusic = Assets::Get().getMusic(MUSIC_NAME);
+        if(overworldMusic != nullptr)
+        {
+            overworldMusic->setLoop(true);
+            overworldMusic->play();
+        }
+    }
+
+    bool ready = overworldMusic != nullptr;
+    for(const Effect& effect : effects) ready = ready && effect.attached;
+    loaded = ready;
+}
+
+void Audio::apply(const Message& message)
+{
+    switch(message.command)
+    {
+    case Command::Events:
+        if(message.value & Game::SoundEvents::ToggleSound)
+        {
+            playSounds = !playSounds;
+        }
+
+        if((message.value & Game::SoundEvents::ToggleMusic) && overworldMusic != nullptr)
+        {
+            if(overworldMusic->getStatus() == sf::Sound::Playing)
+            {
+                overworldMusic->pause();
+            } else {
+                overworldMusic->play();
+            }
+        }
+
+        if(playSounds)
+        {
+            for(std::size_t i = 0; i < EFFECT_COUNT; ++i)
+                if((message.value & SoundEventBit(i)) && effects[i].attached) effects[i].play();
+        }
+        break;
+
+    case Command::Focus: focus = message.value; break;
+    case Command::Editor: editor = message.value; break;
+    case Command::LowGravity: lowGravity = message.value; break;
+    }
+}
+
+// Pitch and volume, only given to the device when they change
+void Audio::mix()
+{
+    for(std::size_t i = 0; i < EFFECT_COUNT; ++i)
+    {
+        const bool slowed = lowGravity && (LOWGRAVITY_EFFECTS & SoundEventBit(i));
+        effects[i].setPitch(slowed ? EFFECT_PITCH[i] / LOWGRAVITY_PITCH : EFFECT_PITCH[i]);
+    }
+
+    if(overworldMusic == nullptr) return;
+
+    double pitch = OVERWORLD_PITCH;
+    if(editor) pitch = EDITOR_PITCH;
+    else if(lowGravity) pitch = OVERWORLD_PITCH / LOWGRAVITY_PITCH;
+
+    const double volume = focus ? OVERWORLD_VOL : LOST_FOCUS_VOL;
+
+    if(pitch != musicPitch) overworldMusic->setPitch(musicPitch = pitch);
+    if(volume != musicVolume) overworldMusic->setVolume(musicVolume = volume);
+}
@@ -11,113 +11,28 @@ bool Game::GameTypeData::getProp(TypePropsType prop) const
     return (propertys & prop) != 0;
 }
 
+// Texture offset of a camera position, the +0.5 rounds XRand
+double Game::GameTypeData::texturePhase(IntType cx) const
+{
+    return cx * cameraSpeed - FrameContext::Get().globalFrame * textureSpeed + 0.5;
+}
+
 IntType Game::GameTypeData::randomize(IntType cx, IntType x, IntType y) const
 {
     if(randomness != 0) 
     {
-        const IntType XRand = 1 + x + // Add texture offset
-            (cx * cameraSpeed - GET_GLOBAL_FRAME() * textureSpeed + 0.5);
+        const IntType XRand = 1 + x + texturePhase(cx); // Add texture offset
         const IntType YRand = 1 + y;
         
-        return std::abs(RANDOMIZE(XRand * YRand)) % randomness;
+        return Noise::Field::Exact(randomness, XRand, YRand);
     }
 
     return IntType(0);
 }
 
-// Game types and their properties    
-/* ***** TYPE DATA STRUCTURE *****
- * GameType::XXXXX, <--- Game Type
- * {"[Block Name]", [Block Color], [1*], [2*], [3*],
- *      [Type Propertys] | [Type Propertys]
- * }
- * 
- * 1* = Texture Randomness
- * 2* = How Fast Texture Moves With Camera (Paralax)
- * 3* = How Fast Texture Moves On Its Own
- */ 
-const Game::GameTypeLink Game::GameTypeList[GameTypeCount] = {
-    {
-        GameType::Sky, 
-        {"Sky", sf::Color(0, 160, 200), 8, 1.0/3.0, 1.0/GAME_FPS,
-            TypeProps::None
-        }
-    }, {
-        GameType::Ground, 
-        {"Ground", sf::Color(52, 52, 52), 24, 1.0, 0.0,
-            TypeProps::Solid | TypeProps::Jumpable 
-        }
-    }, {
-        GameType::Trap, 
-        {"Trap", sf::Color(220, 32, 0), 32, 0.0, 0,
-            TypeProps::Trap
-        }
-    }, {
-        GameType::Bounce, 
-        {"Bounce", sf::Color(64, 255, 164), 0, 0.0, 0.0,
-            TypeProps::Bounce
-        }
-    }, {
-        GameType::Mud, 
-        {"Mud", sf::Color(130, 60, 10), -12, 1.0, 0.0,
-            TypeProps::Solid | TypeProps::Slow
-        }
-    }, {
-        GameType::Water, 
-        {"Water", sf::Color(0, 64, 255), 8, -1.0/2.0, 0.1,
-            TypeProps::LowGravity | TypeProps::Jumpable
-        }
-    }, {
-        GameType::Smog, 
-        {"Smog", sf::Color(128, 128, 128), 8, 1.0/6.0, 0.5/GAME_FPS,
-            TypeProps::Smog | TypeProps::StopStorm
-        }
-    }, {
-        GameType::LowGravity, 
-        {"Low Gravity", sf::Color(100, 0, 100), 8, 1.0/3.0, 1.0/GAME_FPS,
-            TypeProps::LowGravity
-        }
-    }, {
-        GameType::MoveRight, 
-        {"Move Right", sf::Color(64, 196, 0), 64, 1, 4.0/9.0,
-            TypeProps::MoveRight | TypeProps::StopStorm
-        }
-    }, {
-        GameType::MoveLeft, 
-        {"Move Left", sf::Color(64, 196, 0), 64, 1, -4.0/9.0,
-            TypeProps::MoveLeft | TypeProps::StopStorm
-        }
-    }, {
-        GameType::Honey, 
-        {"Honey", sf::Color(192, 128, 16), 16, 1.0/3.0, 1.0/GAME_FPS,
-            TypeProps::Slow | TypeProps::LowGravity
-        }
-    }, {
-        GameType::Coin, 
-        {"Coin", sf::Color(255, 200, 16), 56, 0, 4.0/GAME_FPS,
-            TypeProps::Coin
-        }
-    }, {
-        GameType::Goal, 
-        {"Goal", sf::Color(196, 255, 16), 0, 0.0, 0.0,
-            TypeProps::Goal
-        }
-    }
-};
-
 const Game::GameTypeData Game::GetTypeData(GameType input) 
 {
-    for(const GameTypeLink& entry : GameTypeList)
-        if(input == entry.type) return entry.data;
-    return GameTypeList[RANDOMIZE(GET_GLOBAL_FRAME())%GameTypeCount].data;
-}
-
-   
-void Game::loadBufferFromFile(sf::SoundBuffer& buf, const std::string& name)
-{
-    for(const std::string& ext : SOUND_EXTENTIONS)
-        if(buf.loadFromFile(SOUND_DIRECTORY + name + ext))
-            break;
+    return GameTypeList[GetTypeHot(input).index].data;
 }
 
 /****************************/
@@ -127,143 +42,87 @@ void Game::loadBufferFromFile(sf::SoundBuffer& buf, const std::string& name)
 Game::Game() 
 {
     loadWorld(START_LEVEL); 
-    loadBufferFromFile(coinBuffer, "Coin");
-    coinSound.setBuffer(coinBuffer);
-    coinSound.setPitch(COIN_PITCH);
-    coinSound.setVolume(COIN_VOL);
-    coinSound.setLoop(false);
-
-    loadBufferFromFile(jumpBuffer, "Jump");
-    jumpSound.setBuffer(jumpBuffer);
-    jumpSound.setPitch(JUMP_PITCH);
-    jumpSound.setVolume(JUMP_VOL);
-    jumpSound.setLoop(false);
-
-    loadBufferFromFile(bounceBuffer, "Bounce");
-    bounceSound.setBuffer(bounceBuffer);
-    bounceSound.setPitch(BOUNCE_PITCH);
-    bounceSound.setVolume(BOUNCE_VOL);
-    bounceSound.setLoop(false);
-    
-    loadBufferFromFile(deathBuffer, "Death");
-    deathSound.setBuffer(deathBuffer);
-    deathSound.setPitch(DEATH_PITCH);
-    deathSound.setVolume(DEATH_VOL);
-    deathSound.setLoop(false);
-    
-    loadBufferFromFile(winBuffer, "Win");
-    winSound.setBuffer(winBuffer);
-    winSound.setPitch(WIN_PITCH);
-    winSound.setVolume(WIN_VOL);
-    winSound.setLoop(false);
-
-    for(const std::string& ext : SOUND_EXTENTIONS)
-        if(overworldMusic.openFromFile(SOUND_DIRECTORY + "Overworld" + ext))
-            break;
-    overworldMusic.setPitch(OVERWORLD_PITCH);
-    overworldMusic.setVolume(OVERWORLD_VOL);
-    overworldMusic.setLoop(true);
-    overworldMusic.play();
 }
 
 /********************/
 /***** CONTROLS *****/
 /********************/
- 
-float Game::joyXAxis()
-{ 
-    return sf::Joystick::getAxisPosition(DEFAULT_JOYSTICK_PORT, sf::Joystick::X)
-         + sf::Joystick::getAxisPosition(DEFAULT_JOYSTICK_PORT, sf::Joystick::PovX); 
-}
 
-float Game::joyYAxis()
-{ 
-    return sf::Joystick::getAxisPosition(DEFAULT_JOYSTICK_PORT, sf::Joystick::Y)
-         + sf::Joystick::getAxisPosition(DEFAULT_JOYSTICK_PORT, sf::Joystick::PovY); 
-}
-
-bool Game::resetKey()
+bool Game::resetKey() const
 {
-    return sf::Keyboard::isKeyPressed(sf::Keyboard::Escape)
-        || sf::Joystick::isButtonPressed(DEFAULT_JOYSTICK_PORT, RESET_BUTTON); 
+    return input.get(Input::Button::Reset);
 }
 
-bool Game::upKey()
+bool Game::upKey() const
 {
-    return (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)
-         || sf::Keyboard::isKeyPressed(sf::Keyboard::W)
-         || joyYAxis() < -Y_JOYSTICK_DEAD_ZONE) && !cheatKey(); 
+    return input.get(Input::Button::Up);
 }
 
-bool Game::downKey()
+bool Game::downKey() const
 {
-    return (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)
-         || sf::Keyboard::isKeyPressed(sf::Keyboard::S)
-         || joyYAxis() > Y_JOYSTICK_DEAD_ZONE) && !cheatKey(); 
+    return input.get(Input::Button::Down);
 }
 
-bool Game::leftKey() 
-{ 
-    return (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)
-         || sf::Keyboard::isKeyPressed(sf::Keyboard::A)
-         || joyXAxis() < -X_JOYSTICK_DEAD_ZONE) && !cheatKey(); 
+bool Game::leftKey() const
+{
+    return input.get(Input::Button::Left);
 }
 
-bool Game::rightKey()
+bool Game::rightKey() const
 {
-    return (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)
-         || sf::Keyboard::isKeyPressed(sf::Keyboard::D)
-         || joyXAxis() > X_JOYSTICK_DEAD_ZONE) && !cheatKey(); 
+    return input.get(Input::Button::Right);
 }
 
-bool Game::jumpKey(GravityType gravity)
+bool Game::jumpKey() const
 {
-    for(auto ID : JUMP_BUTTONS)
-        if(sf::Joystick::isButtonPressed(DEFAULT_JOYSTICK_PORT, ID))
-            return true; 
-
-    return sf::Keyboard::isKeyPressed(sf::Keyboard::Space)
+    return input.get(Input::Button::Jump)
         || (upKey() && gravity == GravityType::Down) 
         || (downKey() && gravity == GravityType::Up);
 }
 
-bool Game::cheatKey()
-{
-    return sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)
-        && sf::Keyboard::isKeyPressed(sf::Keyboard::LShift);
-}
-
-bool Game::flyCheatKey()
+bool Game::flyCheatKey() const
 {
-    return cheatKey() && sf::Keyboard::isKeyPressed(sf::Keyboard::F);
+    return pressed(Input::Button::Fly);
 }
 
-bool Game::levelCheatKey()
+bool Game::levelCheatKey() const
 {
-    return cheatKey() && sf::Keyboard::isKeyPressed(sf::Keyboard::L);
+    return pressed(Input::Button::SkipLevel);
 }
 
-bool Game::editorCheatKey()
+bool Game::soundKey() const
 {
-    return cheatKey() && sf::Keyboard::isKeyPressed(sf::Keyboard::E);
+    return pressed(Input::Button::ToggleSound);
 }
 
-bool Game::soundKey()
+bool Game::musicKey() const
 {
-    return cheatKey() && sf::Keyboard::isKeyPressed(sf::Keyboard::S);
+    return pressed(Input::Button::ToggleMusic);
 }
 
-bool Game::musicKey()
+// Only true on the tick the button went down
+bool Game::pressed(InputType button) const
 {
-    return cheatKey() && sf::Keyboard::isKeyPressed(sf::Keyboard::M);
+    return input.get(button) && !lastInput.get(button);
 }
 
 /********************/
 /***** GAMELOOP *****/
 /********************/
 
-void Game::gameLoop()
+void Game::gameLoop(const Input::State& inInput)
 {
+    PROFILE_SCOPE("gameLoop");
+    // Where this tick starts from, for drawing between ticks
+    lastPlayer = player;
+    lastCameraX = cameraX;
+    lastCameraY = cameraY;
+
+    // Latch input for this tick
+    lastInput = input;
+    input = inInput;
+    soundEvents = SoundEvents::NoSound;
+
     // Check for game reset command
     resetKeyLoop();
 
@@ -282,9 +141,6 @@ void Game::gameLoop()
     // Check for bouncing blocks
     bounceLoop();
 
-    // Update Joystick before moving
-    sf::Joystick::update();
-
     // Check for user jump
     jumpLoop();
 
@@ -311,11 +167,13 @@ void Game::gameLoop()
 
 void Game::resetKeyLoop()
 {
+    PROFILE_SCOPE("resetKeyLoop");
     if(resetKey()) loadWorld(START_LEVEL); 
 }
 
 void Game::frameTimeLoop()
 {
+    PROFILE_SCOPE("frameTimeLoop");
     ++rawFrame; // Used for game mechanics, must always tick
     if(player.x > START_SIZE && !getWinner()) 
         levelFrames[level] = ++frame;
@@ -328,10 +186,11 @@ void Game::frameTimeLoop()
 
 void Game::goalLoop()
 {
-    if(player.x >= GAME_LENGTH 
+    PROFILE_SCOPE("goalLoop");
+    if(player.x >= IntType(world.getLength()) 
     || getPlayerData().getProp(TypeProps::Goal)) 
     {
-        if(playSounds) winSound.play();
+        soundEvents |= SoundEvents::PlayWin;
         loadWorld(level + 1);
     }
 }
@@ -339,20 +198,20 @@ void Game::goalLoop()
 // Return if player has cheated
 bool Game::cheatLoop()
 {
+    PROFILE_SCOPE("cheatLoop");
     // Developer Key Combos
     if(flyCheatKey())
     {
         enableFly = !enableFly;
-        while(flyCheatKey()){}
     }
 
     if(enableFly)
     {
         setCheater();
         if(player.x > 0 && leftKey()) player.x -= 1; 
-        if(player.x <= GAME_LENGTH && rightKey()) player.x += 1; 
+        if(player.x <= IntType(world.getLength()) && rightKey()) player.x += 1; 
         if(player.y > 0 && upKey()) player.y -= 1; 
-        if(player.y < GAME_HEIGHT - 1 && downKey()) player.y += 1; 
+        if(player.y < IntType(world.getHeight()) - 1 && downKey()) player.y += 1; 
         cameraLoop();
         return true;
     }
@@ -362,7 +221,6 @@ bool Game::cheatLoop()
         setCheater();
         level++;
         loadWorld(level);
-        while(levelCheatKey()) {}
         return true;
     }
 
@@ -371,14 +229,15 @@ bool Game::cheatLoop()
 
 void Game::trapLoop()
 {
+    PROFILE_SCOPE("trapLoop");
     // Trap Detection
-    if(player.y <= 0 || player.y == GAME_HEIGHT - 1
+    if(player.y <= 0 || player.y == IntType(world.getHeight()) - 1
     || getPlayerData().getProp(TypeProps::Trap)
     || player.x - 1 <= trapX/TRAP_SPEED - TRAP_SMOOTH)
     { 
         if(player.x >= START_SIZE && !getWinner())
         { 
-            if(playSounds) deathSound.play();
+            soundEvents |= SoundEvents::PlayDeath;
             ++deaths; 
         }
 
@@ -401,13 +260,14 @@ void Game::trapLoop()
 
 void Game::jumpLoop()
 {
-    if(jumpKey(gravity))
+    PROFILE_SCOPE("jumpLoop");
+    if(jumpKey())
     {
         if(getPlayerData(0, gravity).getProp(TypeProps::Jumpable))
         { 
             if(canJump) 
             {
-                if(playSounds) jumpSound.play();
+                soundEvents |= SoundEvents::PlayJump;
                 gravity = GravityType(-gravity);
             }
             canJump = false;
@@ -417,12 +277,13 @@ void Game::jumpLoop()
 
 void Game::bounceLoop()
 {
+    PROFILE_SCOPE("bounceLoop");
     if(getPlayerData(0, gravity).getProp(TypeProps::Bounce)
     || getPlayerData().getProp(TypeProps::Bounce))
     { 
         if(canBounce) 
         {
-            if(playSounds) bounceSound.play();
+            soundEvents |= SoundEvents::PlayBounce;
             gravity = GravityType(-gravity);
             canJump = false;
         }
@@ -435,6 +296,7 @@ void Game::bounceLoop()
 
 void Game::movementLoop()
 {
+    PROFILE_SCOPE("movementLoop");
     if(getPlayerData(0, gravity).getProp(TypeProps::Slow) 
     || getPlayerData().getProp(TypeProps::Slow))
         if(rawFrame % 2 != 0) return;
@@ -450,10 +312,11 @@ void Game::movementLoop()
 
 void Game::cameraLoop()
 {
+    PROFILE_SCOPE("cameraLoop");
     // Check for right border (377/987 is inverse golden ratio)
     while(player.x - cameraX > RIGHT_CAMERA_BOARDER) // Move Camera Right
     { 
-        if(cameraX < GAME_LENGTH - GAME_WIDTH) ++cameraX; 
+        if(cameraX < IntType(world.getLength()) - GAME_WIDTH) ++cameraX; 
         else break; 
     }
     
@@ -462,10 +325,26 @@ void Game::cameraLoop()
         if(cameraX > 0) --cameraX; 
         else break; 
     }
+
+    while(player.y - cameraY > BOTTOM_CAMERA_BOARDER) // Move Camera Down
+    { 
+        if(cameraY < IntType(world.getHeight()) - IntType(GAME_HEIGHT)) ++cameraY; 
+        else break; 
+    }
+
+    while(player.y - cameraY < TOP_CAMERA_BOARDER) // Move Camera Up
+    { 
+        if(cameraY > 0) --cameraY; 
+        else break; 
+    }
+
+    // Have the chunks on either side read before they scroll into view
+    world.prefetch(cameraX - CHUNK_WIDTH, cameraX + GAME_WIDTH + CHUNK_WIDTH);
 }
 
 void Game::gravityLoop()
 {
+    PROFILE_SCOPE("gravityLoop");
     // You cant use ground block data as player moved in the movement loop
     if(!getPlayerData(0, gravity).getProp(TypeProps::Solid))
     {
@@ -477,9 +356,10 @@ void Game::gravityLoop()
 
 void Game::coinLoop()
 {
+    PROFILE_SCOPE("coinLoop");
     if(getPlayerData().getProp(TypeProps::Coin))
     {
-        if(playSounds) coinSound.play();
+        soundEvents |= SoundEvents::PlayCoin;
 
         // Count Coin
         ++coins;
@@ -508,42 +388,18 @@ void Game::coinLoop()
         // Use sky as backup
         else 
         { 
-            world[player.x][player.y] = GameType::Sky; 
+            getWorldRef(player.x, player.y) = GameType::Sky; 
         }
+
+        markDirty(player.x, player.y);
     }
 }
 
 void Game::soundLoop()
 {
-    if(soundKey())
-    {
-        playSounds = !playSounds;
-        while(soundKey()){}
-    }
-
-    if(musicKey())
-    {
-        if(overworldMusic.getStatus() == sf::Sound::Playing)
-        {
-            overworldMusic.pause();
-        } else {
-            overworldMusic.play();
-        }
-
-        while(musicKey()){}
-    }
-
-    if(getPlayerData().getProp(TypeProps::LowGravity))
-    {
-        overworldMusic.setPitch(OVERWORLD_PITCH / LOWGRAVITY_PITCH);
-        jumpSound.setPitch(JUMP_PITCH / LOWGRAVITY_PITCH);
-        bounceSound.setPitch(BOUNCE_PITCH / LOWGRAVITY_PITCH);
-    } else 
-    {
-        overworldMusic.setPitch(OVERWORLD_PITCH);
-        jumpSound.setPitch(JUMP_PITCH);
-        bounceSound.setPitch(BOUNCE_PITCH);
-    }
+    PROFILE_SCOPE("soundLoop");
+    if(soundKey()) soundEvents |= SoundEvents::ToggleSound;
+    if(musicKey()) soundEvents |= SoundEvents::ToggleMusic;
 }
 
 void Game::reset()
@@ -555,6 +411,12 @@ void Game::reset()
     trapX = TRAP_START;
     rawFrame = 0;
     cameraX = 0;
+    cameraY = 0;
+
+    // Nothing to slide from
+    lastPlayer = player;
+    lastCameraX = cameraX;
+    lastCameraY = cameraY;
 
     // Total Reset
     if(level == START_LEVEL) {
@@ -573,13 +435,29 @@ void Game::reset()
 
 IntType Game::loadWorld(const IntType inLevel)
 {
-    std::ifstream levelFile(LEVEL_FOLDER + LEVEL_PREFIX + std::to_string(inLevel) + LEVEL_EXTENTION);
-    level = inLevel % MAX_LEVEL_COUNT;
+    PROFILE_SCOPE("loadWorld");
+    // Level files are only checked again by updateLevelHash()
+    if(!levels.isValid()) updateLevelHash();
 
-    if(!Loader::LoadWorld(level, world, false))
+    // Gaps in the level numbers are skipped without looking at the disk
+    level = levels.findLevel(inLevel % MAX_LEVEL_COUNT);
+    if(level < 0)
+    {
+        // No levels at all, play on a blank one
+        level = inLevel % MAX_LEVEL_COUNT;
+        world.blank();
+    } else if(!cache.load(level, world))
+    {
+        // Removed since the levels were last checked
+        updateLevelHash();
         return loadWorld(level + 1);
+    }
 
-    updateLevelHash();
+    // Have the next level ready before the goal is reached
+    const IntType next = levels.findLevel((level + 1) % MAX_LEVEL_COUNT);
+    if(next >= 0) cache.prefetch(next);
+
+    invalidateRender();
 
     if(!getWinner())
     {
@@ -593,147 +471,196 @@ IntType Game::loadWorld(const IntType inLevel)
     return level;
 }
 
-// Render Game
-const Byte* Game::returnWorldPixels(bool focus)
+// Render Game, only redrawing pixels that could have changed. Without
+// the player it can be drawn on top between ticks, see getView()
+const Byte* Game::returnWorldPixels(bool focus, bool drawPlayer)
 {
-    const bool smog = getPlayerData().getProp(TypeProps::Smog);    
-    for(IntType y = 0; y < GAME_HEIGHT; y++)
+    PROFILE_SCOPE("returnWorldPixels");
+    const bool smog = getPlayerData().getProp(TypeProps::Smog);
+    const IntType globalFrame = FrameContext::Get().globalFrame;
+
+    // Anything that touches every pixel needs a full redraw
+    const bool fullRedraw = !render.valid || cameraX != render.cameraX 
+        || cameraY != render.cameraY || smog || render.smog;
+
+    // Columns where each animated texture moved since the last frame
+    ColumnMask animated[GameTypeCount] = {};
+    for(IntType i = 0; i < GameTypeCount; ++i)
     {
-        for(IntType x = 0; x < GAME_WIDTH; x++)
+        const GameTypeData& data = GameTypeList[i].data;
+        const double phase = cameraX * data.cameraSpeed - globalFrame * data.textureSpeed + 0.5;
+        if(!fullRedraw && data.randomness != 0 && phase != render.phase[i])
         {
-            IntType R, G, B;
-            if(cameraX + x == player.x && y == player.y)
-            {
-                R = PLAYER_COLOR.r; 
-                G = PLAYER_COLOR.g; 
-                B = PLAYER_COLOR.b;
-            } else 
-            {
-                // Current Pixel
-                const GameTypeData pixelData = getWorldData(cameraX + x, y);
-
-                // Values to feed into buffer
-                R = pixelData.color.r; 
-                G = pixelData.color.g; 
-                B = pixelData.color.b;
-                
-                // Randomize Color
-                IntType random = pixelData.randomize(cameraX, x, y);
-                R += random; G += random; B += random;
-
-                // Smog
-                if(smog)
-                {
-                    double dis = std::max(
-                        1.0, 
-                        std::hypot(double(player.x - (x + cameraX)), double(player.y - y)) - SMOG_SIZE
-                    );
-                    IntType smogRand = RANDOMIZE(frame*(x+cameraX+1)*(y+1))%4;
-                    R /= dis*dis;  G /= dis*dis;  B /= dis*dis;
-                    R += smogRand; G += smogRand; B += smogRand; 
-                } 
-            }
+            for(IntType x = 0; x < GAME_WIDTH; ++x)
+                if(IntType(1 + x + phase) != IntType(1 + x + render.phase[i]))
+                    animated[i] |= ColumnBit(x);
+        }
+        render.phase[i] = phase;
+    }
 
-            // Start Area
-            if(x + cameraX <= START_SIZE) G += 48;
+    // Smog dither moves every frame
+    if(smog) render.smogOffset = Pixels::SmogKernel::DitherOffset(frame);
 
-            // Trap Wall
-            if(x + cameraX <= trapX/TRAP_SPEED) 
-            {
-                const double red = -(256.0/TRAP_SMOOTH)*(x + cameraX - trapX/TRAP_SPEED);
-                R += red;
-                G -= red/4.0;
-                B -= red/4.0;
-            }
+    // Where the player was and is now
+    markDirty(render.player.x, render.player.y);
+    markDirty(player.x, player.y);
 
-            if(!focus)
+    // The trap wall and focus are applied to whole rows after the base colour
+    const bool reshade = fullRedraw || trapX != render.trapX || focus != render.focus;
+    const Pixels::Shade shade = Pixels::Shade::Make(cameraX, trapX, focus);
+
+    for(IntType y = 0; y < IntType(GAME_HEIGHT); y++)
+    {
+        const ColumnMask rowColumns = render.dirtyRows[y];
+        render.dirtyRows[y] = 0;
+
+        bool rowChanged = reshade;
+        for(IntType x = 0; x < GAME_WIDTH; x++)
+        {
+            if(!fullRedraw && (rowColumns & ColumnBit(x)) == 0)
             {
-                R = (R + 256.0*(LOST_FOCUS_COLOR - 1.0)) / LOST_FOCUS_COLOR;
-                G = (G + 256.0*(LOST_FOCUS_COLOR - 1.0)) / LOST_FOCUS_COLOR;
-                B = (B + 256.0*(LOST_FOCUS_COLOR - 1.0)) / LOST_FOCUS_COLOR;
+                // Unknown blocks change every frame
+                const GameTypeHot& pixelData = GameTypeTable[getWorld(cameraX + x, cameraY + y)];
+                if(pixelData.index != UNKNOWN_TYPE
+                && (animated[pixelData.index] & ColumnBit(x)) == 0) continue;
             }
 
-            // Cap RGB Values
-            buffer[y][x][0] = static_cast<Byte>(std::max(std::min(R, IntType(255)), IntType(0))); // Red
-            buffer[y][x][1] = static_cast<Byte>(std::max(std::min(G, IntType(255)), IntType(0))); // Green
-            buffer[y][x][2] = static_cast<Byte>(std::max(std::min(B, IntType(255)), IntType(0))); // Blue
-            buffer[y][x][3] = 255; // Alpha
+            renderBase(x, y, smog, drawPlayer);
+            rowChanged = true;
         }
+
+        if(rowChanged) Pixels::ShadeRow(render.base[y], shade, &buffer[y][0][0]);
     }
 
+    render.valid = true;
+    render.focus = focus;
+    render.smog = smog;
+    render.cameraX = cameraX;
+    render.cameraY = cameraY;
+    render.trapX = trapX;
+    render.player = player;
+
     return reinterpret_cast<const Byte*>(buffer);
 }
 
-HashType Game::updateLevelHash() 
+// Block color, texture and smog of one pixel, before the row stages
+void Game::renderBase(IntType x, IntType y, bool smog, bool drawPlayer)
 {
-    #define ROTATE(x, rot) (((x) << (rot)) | ((x) >> (sizeof(x)*8 - (rot))))
-
-    HashType oldHash = hash; hash = 0; 
-    HashType oldCoins = maxCoins; maxCoins = 0;
-    HashType oldFinalLevel = finalLevel; finalLevel = 0;
-    for(IntType& t : levelMaxCoins) t = 0;
-    
-    GameType hashWorld[GAME_LENGTH][GAME_HEIGHT];
-    for(IntType lvl = 0; lvl < MAX_LEVEL_COUNT; ++lvl)
+    IntType R, G, B;
+    if(drawPlayer && cameraX + x == player.x && cameraY + y == player.y)
+    {
+        R = PLAYER_COLOR.r; 
+        G = PLAYER_COLOR.g; 
+        B = PLAYER_COLOR.b;
+    } else 
     {
-        if(Loader::LoadWorld(lvl, hashWorld, false))
+        // Current Pixel
+        const GameTypeHot& pixelData = getWorldData(cameraX + x, cameraY + y);
+
+        // Values to feed into buffer
+        R = pixelData.color.r; 
+        G = pixelData.color.g; 
+        B = pixelData.color.b;
+        
+        // Randomize Color
+        IntType random = pixelData.texture(render.phase[pixelData.index], x, cameraY + y);
+        R += random; G += random; B += random;
+
+        // Smog
+        if(smog)
         {
-            if(finalLevel < lvl) { finalLevel = lvl; }
-            for(IntType x = 0; x < GAME_LENGTH; ++x)
-            {
-                for(IntType y = 0; y < GAME_HEIGHT; ++y)
-                {
-                    if(GetTypeData(hashWorld[x][y]).getProp(TypeProps::Coin))
-                    { 
-                        ++levelMaxCoins[lvl];
-                        ++maxCoins; 
-                    }
-
-                    hash += ROTATE(hash, 7);
-                    hash += ROTATE(hash, 20 + (19*lvl)%23);
-                    hash += LookUp::PiTable[(
-                        x*GAME_HEIGHT +
-                        y + hashWorld[x][y]
-                    ) & 0xff];
-                    hash += ROTATE(hash, 43);
-                }
-            }
-        } else {
-            for(IntType round = 0; round < 0x100; ++round)
-            {
-                hash += ROTATE(hash, 7);
-                hash += ROTATE(hash, 20 + (19*lvl)%23);
-                hash += LookUp::PiTable[Byte(round)];
-                hash += ROTATE(hash, 43);
-            }
-        }
+            const Pixels::SmogKernel& kernel = Pixels::SmogKernel::Get();
+            const IntType dx = player.x - (x + cameraX), dy = player.y - (y + cameraY);
+            R = kernel.attenuate(R, dx, dy);
+            G = kernel.attenuate(G, dx, dy);
+            B = kernel.attenuate(B, dx, dy);
+
+            const IntType smogRand = kernel.dither(x + cameraX, y + cameraY, render.smogOffset);
+            R += smogRand; G += smogRand; B += smogRand; 
+        } 
     }
 
-    // Final Mix
-    for(IntType round = 0; round < 0x100; ++round)
-    {
-        hash += ROTATE(hash, 7);
-        hash += ROTATE(hash, 20 + (19*round)%23);
-        hash += LookUp::PiTable[Byte(round)];
-        hash += ROTATE(hash, 43);
-    }
+    render.base[y].r[x] = R;
+    render.base[y].g[x] = G;
+    render.base[y].b[x] = B;
+}
+
+// alpha is how far through the next tick this frame is, from 0 to 1.
+// Anything that moved further than MAX_INTERPOLATE jumped there, like
+// after dying, so everything is shown where it is now instead
+Game::View Game::getView(double alpha, bool focus) const
+{
+    const bool jumped = std::abs(player.x - lastPlayer.x) > MAX_INTERPOLATE
+        || std::abs(player.y - lastPlayer.y) > MAX_INTERPOLATE
+        || std::abs(cameraX - lastCameraX) > MAX_INTERPOLATE
+        || std::abs(cameraY - lastCameraY) > MAX_INTERPOLATE;
+    if(jumped) alpha = 1;
+
+    View view;
+    view.cameraX = Interpolate(lastCameraX, cameraX, alpha);
+    view.cameraY = Interpolate(lastCameraY, cameraY, alpha);
+    view.playerX = Interpolate(lastPlayer.x, player.x, alpha);
+    view.playerY = Interpolate(lastPlayer.y, player.y, alpha);
+
+    // The player's pixel goes through the same row stages as the screen
+    Pixels::Row row;
+    row.r[0] = PLAYER_COLOR.r;
+    row.g[0] = PLAYER_COLOR.g;
+    row.b[0] = PLAYER_COLOR.b;
+
+    Byte shaded[GAME_WIDTH][4];
+    Pixels::ShadeRow(row, Pixels::Shade::Make(player.x, trapX, focus), &shaded[0][0]);
+    view.player = sf::Color(shaded[0][0], shaded[0][1], shaded[0][2]);
+
+    return view;
+}
+
+double Game::Interpolate(IntType from, IntType to, double alpha)
+{
+    return from + (to - from) * std::min(std::max(alpha, 0.0), 1.0);
+}
+
+// World position that needs to be redrawn next frame
+void Game::markDirty(IntType worldX, IntType worldY)
+{
+    const IntType x = worldX - cameraX, y = worldY - cameraY;
+    if(x >= 0 && x < GAME_WIDTH && y >= 0 && y < IntType(GAME_HEIGHT))
+        render.dirtyRows[y] |= ColumnBit(x);
+}
+
+void Game::invalidateRender()
+{
+    render.valid = false;
+}
+
+// Only rereads level files whose size or time changed
+HashType Game::updateLevelHash() 
+{
+    PROFILE_SCOPE("updateLevelHash");
+    const HashType oldHash = hash;
+    const IntType oldFinalLevel = finalLevel;
+
+    if(levels.refresh()) cache.clear();
+    hash = levels.getHash();
+    finalLevel = levels.getFinalLevel();
 
     if(hash != oldHash 
     || finalLevel != oldFinalLevel) setCheater();
 
-    #undef ROTATE
-
     return hash;
 }
 
 /*****************************/
 /***** GETTERS / SETTERS *****/
 /*****************************/
-void Game::setSound(bool value)
+SoundEventType Game::getSoundEvents() const
 {
-    playSounds = value;
-    if(playSounds) overworldMusic.pause();
-    else overworldMusic.play();
+    return soundEvents;
+}
+
+bool Game::getLowGravity() const
+{
+    return getPlayerData().getProp(TypeProps::LowGravity);
 }
 
 
@@ -742,6 +669,11 @@ IntType Game::getCameraX() const
     return cameraX; 
 }
 
+IntType Game::getCameraY() const 
+{ 
+    return cameraY; 
+}
+
 
 IntType Game::getLevel() const 
 { 
@@ -772,7 +704,7 @@ IntType Game::getCoins() const
 
 IntType Game::getMaxCoins() const
 {
-    return maxCoins;
+    return levels.getTotalCoins();
 }
 
 IntType Game::getLevelCoins(IntType level) const
@@ -784,9 +716,7 @@ IntType Game::getLevelCoins(IntType level) const
 
 IntType Game::getLevelMaxCoins(IntType level) const
 {    
-    level = std::max(level, IntType(0));
-    level = std::min(level, MAX_LEVEL_COUNT);
-    return levelMaxCoins[level];
+    return levels.getCoins(level);
 }
 
 
@@ -803,29 +733,56 @@ IntType Game::getLevelFrame(IntType level) const
 }
 
 
+IntType Game::getLevelLength() const
+{
+    return world.getLength();
+}
+
+IntType Game::getLevelHeight() const
+{
+    return world.getHeight();
+}
+
 GameType Game::getWorld(IntType x, IntType y) const
 {
-    return world[std::min(std::max(x, 0), IntType(GAME_LENGTH-1))]
-                [std::min(std::max(y, 0), IntType(GAME_HEIGHT-1))];
+    return world.get(x, y);
 }
 
 GameType& Game::getWorldRef(IntType x, IntType y)
 {
-    return world[std::min(std::max(x, 0), IntType(GAME_LENGTH-1))]
-                [std::min(std::max(y, 0), IntType(GAME_HEIGHT-1))];
+    return world.ref(x, y);
 }
 
-Game::GameTypeData Game::getWorldData(IntType x, IntType y) const
+const Game::GameTypeHot& Game::getWorldData(IntType x, IntType y) const
 {
-    return GetTypeData(getWorld(x, y));
+    return GetTypeHot(getWorld(x, y));
 }
 
-Game::GameTypeData Game::getPlayerData(IntType relX, IntType relY) const
+const Game::GameTypeHot& Game::getPlayerData(IntType relX, IntType relY) const
 {
     return getWorldData(player.x + relX, player.y + relY);
 }
 
 
+Game::PlayerState Game::getPlayerState() const
+{
+    return {player, trapX, rawFrame, gravity, canJump, canBounce};
+}
+
+void Game::setPlayerState(const PlayerState& state)
+{
+    player = state.player;
+    trapX = state.trapX;
+    rawFrame = state.rawFrame;
+    gravity = state.gravity;
+    canJump = state.canJump;
+    canBounce = state.canBounce;
+
+    // Nothing to slide from
+    lastPlayer = player;
+}
+
+
 bool Game::getCheater() const 
 { 
     return hasCheated; 
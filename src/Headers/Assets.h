@@ -0,0 +1,192 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "Constants.h"
+
+#include <future> // Loading on worker threads
+#include <map> // Assets by name
+#include <memory> // Stable addresses
+#include <mutex> // Guarding the maps
+#include <ostream> // Load time report
+
+// Fonts, sounds and music, each read from disk once on its own thread and
+// then shared by everything that asks for it by name. Anything handed out
+// lives until the game closes.
+class Assets
+{
+public:
+    static Assets& Get()
+    {
+        static Assets assets;
+        return assets;
+    }
+
+    // Starts reading everything the game uses without waiting for any of it
+    void preload()
+    {
+        request(fonts, ttfFile, &Assets::LoadFont);
+        for(const std::string& name : SOUND_NAMES) request(sounds, name, &Assets::LoadSound);
+        request(music, MUSIC_NAME, &Assets::LoadMusic);
+    }
+
+    // Waits for the font if it isn't ready yet, nothing if it can't be read
+    const sf::Font* getFont(const std::string& file)
+    {
+        Entry<sf::Font>& entry = request(fonts, file, &Assets::LoadFont);
+        entry.done.wait();
+        return entry.found ? entry.asset.get() : nullptr;
+    }
+
+    // Nothing until they finish loading, so the game never waits on audio.
+    // Files that couldn't be read still come back, just silent.
+    const sf::SoundBuffer* getSound(const std::string& name)
+    {
+        return finished(request(sounds, name, &Assets::LoadSound));
+    }
+
+    sf::Music* getMusic(const std::string& name)
+    {
+        return finished(request(music, name, &Assets::LoadMusic));
+    }
+
+    // True once everything asked for so far is done
+    bool isLoaded()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return AllDone(fonts) && AllDone(sounds) && AllDone(music);
+    }
+
+    // How long each asset took to read, in milliseconds
+    void report(std::ostream& out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Report(out, fonts);
+        Report(out, sounds);
+        Report(out, music);
+    }
+
+private:
+    Assets() {}
+
+    template<class T>
+    struct Entry
+    {
+        std::unique_ptr<T> asset;
+        std::shared_future<void> done;
+        bool found = false;
+        double milliseconds = 0;
+    };
+
+    template<class T>
+    using Cache = std::map<std::string, std::unique_ptr<Entry<T>>>;
+
+    template<class T>
+    using Loader = bool (*)(T&, const std::string&);
+
+    /*******************/
+    /***** LOADERS *****/
+    /*******************/
+
+    static bool LoadFont(sf::Font& font, const std::string& file)
+    {
+        return font.loadFromFile(file);
+    }
+
+    static bool LoadSound(sf::SoundBuffer& buffer, const std::string& name)
+    {
+        for(const std::string& ext : SOUND_EXTENTIONS)
+            if(buffer.loadFromFile(SOUND_DIRECTORY + name + ext))
+                return true;
+        return false;
+    }
+
+    static bool LoadMusic(sf::Music& stream, const std::string& name)
+    {
+        for(const std::string& ext : SOUND_EXTENTIONS)
+            if(stream.openFromFile(SOUND_DIRECTORY + name + ext))
+                return true;
+        return false;
+    }
+
+    template<class T>
+    static void Load(Entry<T>* entry, std::string name, Loader<T> loader)
+    {
+        const auto start = CHRONO_CLOCK::now();
+        entry->found = loader(*entry->asset, name);
+        entry->milliseconds = std::chrono::duration<double, std::milli>(CHRONO_CLOCK::now() - start).count();
+    }
+
+    /*******************/
+    /***** HELPERS *****/
+    /*******************/
+
+    // Starts loading the first time a name is asked for
+    template<class T>
+    Entry<T>& request(Cache<T>& cache, const std::string& name, Loader<T> loader)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unique_ptr<Entry<T>>& entry = cache[name];
+        if(!entry)
+        {
+            entry.reset(new Entry<T>);
+            entry->asset.reset(new T);
+            entry->done = std::async(std::launch::async, &Assets::Load<T>, entry.get(), name, loader).share();
+        }
+        return *entry;
+    }
+
+    template<class T>
+    static T* finished(Entry<T>& entry)
+    {
+        if(!IsDone(entry)) return nullptr;
+        return entry.asset.get();
+    }
+
+    template<class T>
+    static bool IsDone(const Entry<T>& entry)
+    {
+        return entry.done.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    template<class T>
+    static bool AllDone(const Cache<T>& cache)
+    {
+        for(const auto& entry : cache)
+            if(!IsDone(*entry.second)) return false;
+        return true;
+    }
+
+    template<class T>
+    static void Report(std::ostream& out, const Cache<T>& cache)
+    {
+        for(const auto& entry : cache)
+        {
+            out << entry.first << ": ";
+            if(!IsDone(*entry.second)) out << "loading\n";
+            else if(!entry.second->found) out << "missing\n";
+            else out << entry.second->milliseconds << "ms\n";
+        }
+    }
+
+    std::mutex mutex;
+    Cache<sf::Font> fonts;
+    Cache<sf::SoundBuffer> sounds;
+    Cache<sf::Music> music;
+};
+
+static sf::Text GET_DEFAULT_TEXT(double size)
+{
+    const sf::Font* font = Assets::Get().getFont(ttfFile);
+    if(!font) { return sf::Text(); }
+
+    sf::Text defaultText;
+    defaultText.setFont(*font);
+    defaultText.setFillColor(sf::Color::White);
+    defaultText.setOutlineColor(sf::Color::Black);
+    defaultText.setOutlineThickness(size*2.5*TEXT_SCALE);
+    defaultText.setCharacterSize(size*TEXT_SCALE*GAME_SCALE/1.5);
+    defaultText.setScale(sf::Vector2f(1.0/TEXT_SCALE,1.0/TEXT_SCALE));
+    return defaultText;
+}
+
+#endif // ASSETS_H
@@ -0,0 +1,96 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include "Constants.h"
+#include "Game.h"
+#include "SpscQueue.h"
+
+#include <atomic> // Shared with the audio thread
+#include <condition_variable> // Waking the audio thread
+#include <mutex> // Waking the audio thread
+#include <thread> // Audio thread
+#include <type_traits> // Counting sounds
+
+// Plays what the game reports each tick, the game itself is silent
+// so it can run headless without an audio device
+//
+// Everything that touches the audio device happens on the audio thread.
+// The game thread only pushes commands onto a queue, so it never waits
+// on the device, and a full queue drops the command instead of waiting.
+// The audio thread sleeps until a command arrives.
+//
+// Sounds are read in the background by Assets, anything asked
+// for before its sound has loaded is skipped
+class Audio
+{
+public:
+    Audio();
+    ~Audio();
+    Audio(const Audio&) = delete;
+    Audio& operator=(const Audio&) = delete;
+
+    void update(const Game&);
+    void setFocus(bool);
+    void setEditor(bool);
+    bool isLoaded() const;
+
+    std::uintmax_t getDroppedCommands() const;
+
+private: // Game thread
+    enum Command : Byte { Events, Focus, Editor, LowGravity };
+    struct Message
+    {
+        Command command;
+        SoundEventType value;
+    };
+
+    bool send(Command, SoundEventType);
+    void wake();
+
+    bool sentLowGravity = false;
+    std::uintmax_t droppedCommands = 0;
+
+private: // Audio thread
+    // A few voices of the same sound, so playing it again
+    // doesn't cut off the last one
+    struct Effect
+    {
+        sf::Sound voices[SOUND_VOICES];
+        IntType next = 0;
+        bool attached = false;
+        double pitch = 0;
+
+        void play();
+        void setPitch(double);
+    };
+
+    // One for each of SOUND_NAMES, in the same order as SoundEvents
+    static constexpr std::size_t EFFECT_COUNT = std::extent<decltype(SOUND_NAMES)>::value;
+
+    static bool SetupEffect(Effect&, const std::string&, double);
+    void run();
+    void attach();
+    void apply(const Message&);
+    void mix();
+    bool isPlaying() const;
+
+    Effect effects[EFFECT_COUNT];
+    sf::Music* overworldMusic = nullptr;
+
+    // What the game asked for
+    bool playSounds = true, focus = true, editor = false, lowGravity = false;
+
+    // What the device was last given, only changed when these differ
+    double musicPitch = 0, musicVolume = 0;
+
+private: // Shared
+    SpscQueue<Message, AUDIO_QUEUE_SIZE> queue;
+    std::atomic<bool> loaded{false};
+    std::atomic<bool> running{true};
+    std::mutex wakeMutex;
+    std::condition_variable wakeSignal;
+    bool woken = false; // Something was sent since the audio thread last looked
+    std::thread thread; // Started last, after everything it uses
+};
+
+#endif // AUDIO_H
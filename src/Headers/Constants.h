@@ -20,19 +20,39 @@ using IntType = std::int32_t;
 using RawIntType = std::uint32_t;
 using HashType = std::uint64_t;
 using TypePropsType = std::uint64_t;
+using InputType = std::uint16_t;
+using SoundEventType = std::uint8_t;
 
-// Game FPS
+// sf::Color can't be built at compile time, this can
+struct GameColor
+{
+    Byte r, g, b;
+    operator sf::Color() const { return sf::Color(r, g, b); }
+};
+
+// Game FPS, the game ticks at this rate and frames are drawn at the display's
 static constexpr IntType GAME_FPS = 25;
+static constexpr IntType MAX_CATCH_UP_TICKS = 4; // Most ticks run in one frame after a stall
+static constexpr IntType MAX_INTERPOLATE = 2; // Moving further in one tick jumps instead of sliding
+static constexpr IntType MAX_FRAME_RATE = 400; // Frame limit used if the driver ignores vsync
+static constexpr IntType VSYNC_CHECK_FRAMES = 60; // Frames in a row faster than MAX_FRAME_RATE before it's used
 
 // Game Version
 static const std::string GAME_VERSION = "v1.0";
 
 // Game Size / Pixel Measurements
+// GAME_WIDTH x GAME_HEIGHT is the screen, GAME_LENGTH is the length of new levels
 static constexpr IntType GAME_WIDTH = 42;
 static constexpr RawIntType GAME_HEIGHT = 24;
 static constexpr RawIntType GAME_LENGTH = 256;
 static constexpr IntType START_SIZE = 9;
 
+// World Chunks
+static constexpr RawIntType CHUNK_WIDTH = 64; // Columns per chunk, power of 2
+static constexpr std::size_t WORLD_MEMORY_BUDGET = 4 << 20; // Bytes of chunks kept per world
+static constexpr RawIntType MAX_WORLD_HEIGHT = 0x10000;
+static constexpr RawIntType MAX_WORLD_LENGTH = 0x1000000;
+
 static constexpr IntType GAME_START_X = START_SIZE/2;
 static constexpr IntType GAME_START_Y = 18;
 
@@ -43,6 +63,8 @@ static const sf::Color PLAYER_COLOR = sf::Color(0, 0, 0);
 // Sounds
 static const std::string SOUND_DIRECTORY = "./GameFiles/";
 static const std::string SOUND_EXTENTIONS[] = {".wav", ".ogg", ".flac"};
+static const std::string SOUND_NAMES[] = {"Coin", "Jump", "Bounce", "Death", "Win"};
+static const std::string MUSIC_NAME = "Overworld";
 
 static constexpr double COIN_PITCH = 1;
 static constexpr double COIN_VOL = 100;
@@ -63,6 +85,13 @@ static constexpr double OVERWORLD_PITCH = 1;
 static constexpr double OVERWORLD_VOL = 30;
 
 static constexpr double LOWGRAVITY_PITCH = 1.5;
+static constexpr double EDITOR_PITCH = 0.8;
+static constexpr double LOST_FOCUS_VOL = OVERWORLD_VOL/5;
+
+// Audio thread
+static constexpr IntType SOUND_VOICES = 4; // Copies of each sound that can play at once
+static constexpr std::size_t AUDIO_QUEUE_SIZE = 256; // Commands waiting for the audio thread
+static constexpr std::chrono::milliseconds AUDIO_IDLE_TIME(2); // Audio thread checks while sounds load or play
 
 // Global frames
 using CHRONO_CLOCK = std::chrono::steady_clock;
@@ -103,12 +132,24 @@ static constexpr TypePropsType TypePropsBit(IntType bit)
     return TypePropsType(0x1) << bit;
 }
 
+static constexpr InputType InputBit(IntType bit) 
+{ 
+    return InputType(0x1) << bit;
+}
+
+static constexpr SoundEventType SoundEventBit(IntType bit) 
+{ 
+    return SoundEventType(0x1) << bit;
+}
+
 // Game Text
 static constexpr double TEXT_SCALE = 4;
 
 // Game Camera Measurements
 static constexpr IntType RIGHT_CAMERA_BOARDER = GAME_WIDTH / 2;
 static constexpr IntType LEFT_CAMERA_BOARDER = GAME_WIDTH / 3;
+static constexpr IntType TOP_CAMERA_BOARDER = IntType(GAME_HEIGHT) / 3;
+static constexpr IntType BOTTOM_CAMERA_BOARDER = IntType(GAME_HEIGHT) * 2 / 3;
 
 // Controls 
 static constexpr IntType DEFAULT_JOYSTICK_PORT = 0;
@@ -135,26 +176,14 @@ static constexpr IntType TEXT_X = 1;
 static constexpr IntType TEXT_Y = 9;
 static const sf::Color GOOD_COLOR = sf::Color(196,255,196);
 static const sf::Color BAD_COLOR = sf::Color(255,196,196);
-static const std::string ttfFile = "./GameFiles/GameFont.ttf";
-static sf::Font DEFAULT_GAME_FONT;
-
-static sf::Text GET_DEFAULT_TEXT(double size)
-{
-    if(!DEFAULT_GAME_FONT.loadFromFile(ttfFile)) { return sf::Text(); }
-
-    sf::Text defaultText;
-    defaultText.setFont(DEFAULT_GAME_FONT);
-    defaultText.setFillColor(sf::Color::White);
-    defaultText.setOutlineColor(sf::Color::Black);
-    defaultText.setOutlineThickness(size*2.5*TEXT_SCALE);
-    defaultText.setCharacterSize(size*TEXT_SCALE*GAME_SCALE/1.5);
-    defaultText.setScale(sf::Vector2f(1.0/TEXT_SCALE,1.0/TEXT_SCALE));
-    return defaultText;
-}
+static const std::string ttfFile = "./GameFiles/GameFont.ttf"; // GET_DEFAULT_TEXT() is in Assets.h
 
 // Level Editor
-static constexpr IntType EDITOR_CAMERA_SPEED = 2;
+static constexpr std::chrono::milliseconds EDITOR_CAMERA_TIME(33); // The editor camera moves a block this often while a key is held
 static constexpr IntType BLOCK_LIST_SIZE = 8;
+static constexpr std::chrono::milliseconds EDITOR_ANIMATION_TIME(100); // Redraw for animated blocks when nothing else changed
+static constexpr std::chrono::milliseconds EDITOR_IDLE_TIME(25); // Sleep between checks for input while waiting to animate or save
+static constexpr std::chrono::seconds EDITOR_AUTOSAVE_TIME(30); // Unsaved edits are written to the side this often
 
 // Sorting Blocks By Brightness
 static constexpr IntType R_LUMINANCE = 2126;
@@ -195,6 +224,8 @@ static IntType RANDOMIZE(IntType n)
 static const std::string LEVEL_FOLDER = "./Levels/";
 static const std::string LEVEL_PREFIX = "L";
 static const std::string LEVEL_EXTENTION = ".lvl";
+static const std::string AUTOSAVE_EXTENTION = ".autosave"; // After the level's name, unsaved edits from the editor
+static const std::string TEMP_EXTENTION = ".tmp"; // Written first, then renamed over the real file
 static const IntType LEVEL_HASH_TIME = GAME_FPS*4;
 
 #endif // CONSTANTS_H_INCLUDED
@@ -3,33 +3,49 @@
 
 #include "./Constants.h"
 
+#include <algorithm> // Filling missing columns
+#include <cstdio> // Writing levels
+#include <filesystem> // Replacing levels
+#include <vector> // Chunk table, packed chunks
+
+// Making sure a level is on the disk before it replaces the old one
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace Loader
 {
-    struct HeaderData
+    static constexpr RawIntType LEVEL_VERSION = 2;
+
+    static void SaveNumber(Byte* arr, RawIntType num)
     {
-    private: 
-        static void SaveNumber(Byte* arr, RawIntType num)
-        {
-            arr[0] = (num >> 0)  & 0xff;
-            arr[1] = (num >> 8)  & 0xff;
-            arr[2] = (num >> 16) & 0xff;
-            arr[3] = (num >> 24) & 0xff;
-        }
+        arr[0] = (num >> 0)  & 0xff;
+        arr[1] = (num >> 8)  & 0xff;
+        arr[2] = (num >> 16) & 0xff;
+        arr[3] = (num >> 24) & 0xff;
+    }
 
-        static RawIntType ReadNumber(const Byte* arr)
-        {
-            RawIntType out = 0;
-            out |= arr[0] << 0;
-            out |= arr[1] << 8;
-            out |= arr[2] << 16;
-            out |= arr[3] << 24;
-            return out;
-        }
+    static RawIntType ReadNumber(const Byte* arr)
+    {
+        RawIntType out = 0;
+        out |= arr[0] << 0;
+        out |= arr[1] << 8;
+        out |= arr[2] << 16;
+        out |= arr[3] << 24;
+        return out;
+    }
 
+    // Version 1, the blocks follow as they are
+    struct HeaderData
+    {
+    private:
         Byte header[12];
 
-    public: 
-        HeaderData() {}
+    public:
+        HeaderData() : header() {}
         HeaderData(RawIntType magicNumber, RawIntType height, RawIntType length)
         {
             SaveNumber(&header[0], magicNumber);
@@ -44,81 +60,485 @@ namespace Loader
         RawIntType getLength() const { return ReadNumber(&header[8]); }
     };
 
-    static bool LoadWorld(const IntType inLevel, GameType world[][GAME_HEIGHT], bool clearWorld = true)
+    // Version 2 starts the same with a height of 0, which no version 1
+    // level has, followed by the chunk table and the packed chunks
+    struct HeaderDataV2
     {
-        std::ifstream levelFile(LEVEL_FOLDER + LEVEL_PREFIX + std::to_string(inLevel) + LEVEL_EXTENTION);
-        if(levelFile.good())
+    private:
+        Byte header[28];
+
+    public:
+        HeaderDataV2() : header() {}
+        HeaderDataV2(RawIntType height, RawIntType length, RawIntType coins, RawIntType checksum)
         {
-            HeaderData header;
-            levelFile.read(reinterpret_cast<char*>(header.getHeaderData()), sizeof(header));
-            if(header.getMagicNumber() != MAGIC_NUMBER)
+            SaveNumber(&header[0], MAGIC_NUMBER);
+            SaveNumber(&header[4], 0);
+            SaveNumber(&header[8], LEVEL_VERSION);
+            SaveNumber(&header[12], height);
+            SaveNumber(&header[16], length);
+            SaveNumber(&header[20], coins);
+            SaveNumber(&header[24], checksum);
+        }
+
+        char* getHeaderData() { return reinterpret_cast<char*>(header); }
+        const char* getHeaderData() const { return reinterpret_cast<const char*>(header); }
+        RawIntType getVersion() const { return ReadNumber(&header[8]); }
+        RawIntType getHeight() const { return ReadNumber(&header[12]); }
+        RawIntType getLength() const { return ReadNumber(&header[16]); }
+        RawIntType getCoins() const { return ReadNumber(&header[20]); }
+        RawIntType getChecksum() const { return ReadNumber(&header[24]); }
+    };
+
+    // Where a chunk is in the file and what it should decode to
+    struct ChunkEntry
+    {
+        static constexpr std::size_t SIZE = 12;
+        RawIntType offset = 0, size = 0, checksum = 0;
+    };
+
+    static std::string LevelPath(const IntType inLevel)
+    {
+        return LEVEL_FOLDER + LEVEL_PREFIX + std::to_string(inLevel) + LEVEL_EXTENTION;
+    }
+
+    inline std::string AutosavePath(const IntType inLevel)
+    {
+        return LevelPath(inLevel) + AUTOSAVE_EXTENTION;
+    }
+
+    static RawIntType ChunkColumns(const RawIntType chunk, const RawIntType length)
+    {
+        const RawIntType first = chunk * CHUNK_WIDTH;
+        return first < length ? std::min(CHUNK_WIDTH, length - first) : 0;
+    }
+
+    /*********************/
+    /***** CHECKSUMS *****/
+    /*********************/
+
+    // FNV-1a, a chunk's is over its blocks, a level's is over its
+    // size and the chunk checksums
+    static constexpr RawIntType CHECKSUM_START = 0x811c9dc5;
+
+    static constexpr RawIntType Checksum(RawIntType sum, Byte value)
+    {
+        return (sum ^ value) * 0x01000193;
+    }
+
+    static RawIntType ChecksumNumber(RawIntType sum, RawIntType num)
+    {
+        for(IntType i = 0; i < 4; ++i) sum = Checksum(sum, Byte(num >> (8*i)));
+        return sum;
+    }
+
+    static RawIntType ChecksumBlocks(const GameType* cells, std::size_t count)
+    {
+        RawIntType sum = CHECKSUM_START;
+        for(std::size_t i = 0; i < count; ++i) sum = Checksum(sum, cells[i]);
+        return sum;
+    }
+
+    /********************/
+    /***** ENCODING *****/
+    /********************/
+
+    // Seven bits at a time, lowest first
+    static void PutCount(std::string& out, RawIntType count)
+    {
+        while(count >= 0x80)
+        {
+            out += char(0x80 | (count & 0x7f));
+            count >>= 7;
+        }
+        out += char(count);
+    }
+
+    static bool GetCount(const Byte*& in, const Byte* end, RawIntType& count)
+    {
+        count = 0;
+        for(IntType shift = 0; shift < 32 && in != end; shift += 7)
+        {
+            const Byte next = *in++;
+            count |= RawIntType(next & 0x7f) << shift;
+            if((next & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    // Blocks are read down each column, then across, as a series of steps.
+    // Each step starts with its length shifted up by two and its kind in the
+    // low bits: a block repeated, blocks the same as the column before, or
+    // blocks stored as they are.
+    enum Step : RawIntType { Repeat = 0, Copy = 1, Literal = 2 };
+    static constexpr std::size_t MIN_STEP = 3; // Anything shorter is left literal
+
+    static void EncodeChunk(const GameType* cells, std::size_t count, RawIntType height, std::string& out)
+    {
+        std::size_t literal = 0;
+        const auto flush = [&](std::size_t end)
+        {
+            if(end == literal) return;
+            PutCount(out, RawIntType(end - literal) << 2 | Step::Literal);
+            out.append(reinterpret_cast<const char*>(cells + literal), end - literal);
+        };
+
+        for(std::size_t i = 0; i < count;)
+        {
+            std::size_t run = 1;
+            while(i + run < count && cells[i + run] == cells[i]) ++run;
+
+            std::size_t copy = 0;
+            if(i >= height)
+                while(i + copy < count && cells[i + copy] == cells[i + copy - height]) ++copy;
+
+            if(std::max(run, copy) < MIN_STEP) 
             {
-                levelFile.close();
-                return false;
+                ++i;
+                continue;
             }
 
-            if(header.getLength() == GAME_LENGTH && header.getHeight() == GAME_HEIGHT)
+            flush(i);
+            if(copy > run)
             {
-                // If Headers Match Game Settings, read directly
-                levelFile.read(reinterpret_cast<char*>(world), GAME_LENGTH*GAME_HEIGHT*sizeof(GameType));
+                PutCount(out, RawIntType(copy) << 2 | Step::Copy);
+                i += copy;
             } else
             {
-                // If Not, do conversions
-                const RawIntType HeaderLength = header.getLength();
-                const RawIntType HeaderHeight = header.getHeight();
-                const RawIntType GameLength = std::min(GAME_LENGTH, HeaderLength);
-                const RawIntType GameHeight = std::min(GAME_HEIGHT, HeaderHeight);
-                for(RawIntType x = 0; x < GAME_LENGTH; ++x)
+                PutCount(out, RawIntType(run) << 2 | Step::Repeat);
+                out += char(cells[i]);
+                i += run;
+            }
+            literal = i;
+        }
+
+        flush(count);
+    }
+
+    // One pass over the blocks that also works out their checksum,
+    // false if the data doesn't fill the chunk exactly
+    static bool DecodeChunk(const Byte* in, const Byte* end, GameType* cells, std::size_t count,
+                            RawIntType height, RawIntType& checksum)
+    {
+        RawIntType sum = CHECKSUM_START;
+        for(std::size_t i = 0; i < count;)
+        {
+            RawIntType step;
+            if(!GetCount(in, end, step)) return false;
+
+            const std::size_t steps = step >> 2;
+            if(steps == 0 || steps > count - i) return false;
+            const std::size_t last = i + steps;
+
+            switch(step & 0x3)
+            {
+            case Step::Repeat:
+            {
+                if(in == end) return false;
+                const GameType block = GameType(*in++);
+                for(; i < last; ++i)
                 {
-                    if(x < GameLength)
-                    {
-                        levelFile.read(reinterpret_cast<char*>(&world[x][0]), GameHeight);
-                        for(RawIntType y = GameHeight; y < GAME_HEIGHT; ++y)
-                            world[x][y] = GameType::Trap; 
-                    } else 
-                    {
-                        for(RawIntType y = 0; y < GAME_HEIGHT; ++y)
-                            world[x][y] = GameType::Goal;
-                    }
-
-                    if(GAME_HEIGHT < HeaderHeight) levelFile.ignore(HeaderHeight - GAME_HEIGHT);
+                    cells[i] = block;
+                    sum = Checksum(sum, block);
                 }
+                break;
             }
+            case Step::Copy:
+                if(i < height) return false;
+                for(; i < last; ++i)
+                {
+                    cells[i] = cells[i - height];
+                    sum = Checksum(sum, cells[i]);
+                }
+                break;
+            case Step::Literal:
+                if(std::size_t(end - in) < steps) return false;
+                for(; i < last; ++i)
+                {
+                    cells[i] = GameType(*in++);
+                    sum = Checksum(sum, cells[i]);
+                }
+                break;
+            default:
+                return false;
+            }
+        }
+
+        checksum = sum;
+        return in == end;
+    }
+
+    static RawIntType CountCoins(const GameType* cells, std::size_t count)
+    {
+        return RawIntType(std::count(cells, cells + count, GameType::Coin));
+    }
+
+    // Every block of a level, a chunk after another, so it can
+    // be written while the level it came from keeps changing
+    struct LevelData
+    {
+        RawIntType length = 0, height = 0;
+        std::vector<GameType> cells;
+
+        std::size_t chunkSize() const { return std::size_t(CHUNK_WIDTH) * height; }
+    };
+
+    // Waits until everything written to file is on the disk, not just
+    // handed to the OS, so a power cut can't leave it half written
+    static bool SyncFile(std::FILE* file)
+    {
+        if(std::fflush(file) != 0) return false;
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return ::fsync(fileno(file)) == 0;
+#endif
+    }
+
+    // The rename itself is only on the disk once the folder is
+    static void SyncFolder(const std::filesystem::path& path)
+    {
+#ifndef _WIN32
+        const std::filesystem::path folder = path.has_parent_path() ? path.parent_path() : ".";
+        const int handle = ::open(folder.c_str(), O_RDONLY);
+        if(handle < 0) return;
+        ::fsync(handle);
+        ::close(handle);
+#else
+        (void)path; // Windows can't open a folder to sync it
+#endif
+    }
+
+    // Writes a level in the newest version, chunks holds every chunk's blocks.
+    // It's written next to path, synced to the disk and renamed over it once
+    // it's all there, so a crash or power cut part way through leaves the
+    // old file as it was.
+    static bool SaveLevel(const std::string& path, RawIntType length, RawIntType height, const GameType* const* chunks)
+    {
+        const RawIntType chunkCount = (length + CHUNK_WIDTH - 1) / CHUNK_WIDTH;
+
+        std::vector<ChunkEntry> table(chunkCount);
+        std::string packed;
+        RawIntType coins = 0;
+        RawIntType checksum = ChecksumNumber(ChecksumNumber(CHECKSUM_START, length), height);
+        for(RawIntType i = 0; i < chunkCount; ++i)
+        {
+            const std::size_t count = std::size_t(ChunkColumns(i, length)) * height;
+            ChunkEntry& entry = table[i];
+            entry.offset = packed.size();
+            entry.checksum = ChecksumBlocks(chunks[i], count);
+            EncodeChunk(chunks[i], count, height, packed);
+            entry.size = packed.size() - entry.offset;
+
+            coins += CountCoins(chunks[i], count);
+            checksum = ChecksumNumber(checksum, entry.checksum);
+        }
+
+        // Offsets are from the start of the file
+        const HeaderDataV2 header(height, length, coins, checksum);
+        const RawIntType dataStart = sizeof(header) + chunkCount * ChunkEntry::SIZE;
+
+        std::string index(chunkCount * ChunkEntry::SIZE, '\0');
+        for(RawIntType i = 0; i < chunkCount; ++i)
+        {
+            Byte* entry = reinterpret_cast<Byte*>(&index[i * ChunkEntry::SIZE]);
+            SaveNumber(&entry[0], dataStart + table[i].offset);
+            SaveNumber(&entry[4], table[i].size);
+            SaveNumber(&entry[8], table[i].checksum);
+        }
+
+        const std::string temp = path + TEMP_EXTENTION;
+        std::FILE* levelFile = std::fopen(temp.c_str(), "wb");
+        if(levelFile == nullptr) return false;
+
+        bool written = std::fwrite(header.getHeaderData(), 1, sizeof(header), levelFile) == sizeof(header)
+                    && std::fwrite(index.data(), 1, index.size(), levelFile) == index.size()
+                    && std::fwrite(packed.data(), 1, packed.size(), levelFile) == packed.size()
+                    && SyncFile(levelFile);
+        written = std::fclose(levelFile) == 0 && written;
+
+        std::error_code error;
+        if(written) std::filesystem::rename(temp, path, error);
+        if(!written || error)
+        {
+            std::filesystem::remove(temp, error);
+            return false;
+        }
+
+        SyncFolder(path);
+        return true;
+    }
+
+    inline bool SaveLevel(const std::string& path, const LevelData& level)
+    {
+        std::vector<const GameType*> chunks;
+        for(std::size_t i = 0; i < level.cells.size(); i += level.chunkSize())
+            chunks.push_back(&level.cells[i]);
+        return SaveLevel(path, level.length, level.height, chunks.data());
+    }
+
+    /*******************/
+    /***** READING *****/
+    /*******************/
+
+    // A level file of any size and either version, read a chunk of columns at a time
+    class LevelFile
+    {
+    public:
+        bool open(const IntType inLevel)
+        {
+            return open(LevelPath(inLevel));
+        }
+
+        bool open(const std::string& path)
+        {
+            close();
+            file.open(path, std::ios::binary);
+            if(!file.good()) return false;
+
+            HeaderData header;
+            file.read(header.getHeaderData(), sizeof(header));
+            if(!file || header.getMagicNumber() != MAGIC_NUMBER) return fail();
+
+            if(header.getHeight() != 0)
+            {
+                version = 1;
+                height = header.getHeight();
+                length = header.getLength();
+                if(!validSize()) return fail();
+            } else if(!openV2()) return fail();
 
-            levelFile.close();
             return true;
-        } else 
+        }
+
+        void close()
         {
-            if(clearWorld)
+            file.close();
+            file.clear();
+            table.clear();
+            version = height = length = coins = checksum = 0;
+        }
+
+        bool isOpen() const { return file.is_open(); }
+        RawIntType getVersion() const { return version; }
+        RawIntType getHeight() const { return height; }
+        RawIntType getLength() const { return length; }
+        RawIntType getChunkCount() const { return (length + CHUNK_WIDTH - 1) / CHUNK_WIDTH; }
+
+        // Checksum and coins of the whole level. Version 2 keeps them in
+        // its header, version 1 has to read every block to get them.
+        void summarize(RawIntType& outChecksum, RawIntType& outCoins)
+        {
+            if(version == 1)
             {
-                for(RawIntType x = 0; x < GAME_LENGTH; ++x)
+                std::vector<GameType> cells(std::size_t(CHUNK_WIDTH) * height);
+                checksum = ChecksumNumber(ChecksumNumber(CHECKSUM_START, length), height);
+                coins = 0;
+                for(RawIntType i = 0; i < getChunkCount(); ++i)
                 {
-                    for(RawIntType y = 0; y < GAME_HEIGHT; ++y)
-                    {
-                        if(x <= START_SIZE && y <= 7)
-                        {
-                            if(x == START_SIZE || y == 7)
-                                world[x][y] = GameType::Trap;
-                            else world[x][y] = GameType::Sky;
-                        } else world[x][y] = (y >= GAME_HEIGHT-3) ? GameType::Ground : GameType::Sky;
-                    }
+                    readChunk(i, cells.data());
+
+                    const std::size_t count = std::size_t(ChunkColumns(i, length)) * height;
+                    checksum = ChecksumNumber(checksum, ChecksumBlocks(cells.data(), count));
+                    coins += CountCoins(cells.data(), count);
                 }
             }
-            levelFile.close();
+
+            outChecksum = checksum;
+            outCoins = coins;
+        }
+
+        // Fills CHUNK_WIDTH columns, anything past the end of the level
+        // is sky, and so is a chunk that is missing or damaged
+        bool readChunk(const RawIntType chunk, GameType* cells)
+        {
+            const std::size_t count = std::size_t(ChunkColumns(chunk, length)) * height;
+            const bool found = version == 1 ? readV1(chunk, cells, count) : readV2(chunk, cells, count);
+
+            std::fill(cells + (found ? count : 0), cells + std::size_t(CHUNK_WIDTH) * height, GameType::Sky);
+            return found;
+        }
+
+    private:
+        bool fail()
+        {
+            close();
             return false;
         }
 
-    }
+        bool validSize() const
+        {
+            return height != 0 && height <= MAX_WORLD_HEIGHT
+                && length != 0 && length <= MAX_WORLD_LENGTH;
+        }
 
-    static void SaveWorld(const IntType inLevel, GameType world[][GAME_HEIGHT])
-    {
-        const HeaderData header(MAGIC_NUMBER, GAME_HEIGHT, GAME_LENGTH);
+        bool openV2()
+        {
+            HeaderDataV2 header;
+            file.seekg(0);
+            file.read(header.getHeaderData(), sizeof(header));
+            if(!file || header.getVersion() != LEVEL_VERSION) return false;
 
-        std::ofstream levelFile(LEVEL_FOLDER + LEVEL_PREFIX + std::to_string(inLevel) + LEVEL_EXTENTION, std::ios::binary);
-        levelFile.write(reinterpret_cast<const char*>(header.getHeaderData()), sizeof(header));
-        levelFile.write(reinterpret_cast<const char*>(world), GAME_LENGTH*GAME_HEIGHT*sizeof(GameType));
-        levelFile.close();
-    }
+            version = header.getVersion();
+            height = header.getHeight();
+            length = header.getLength();
+            coins = header.getCoins();
+            checksum = header.getChecksum();
+            if(!validSize()) return false;
+
+            std::vector<Byte> index(std::size_t(getChunkCount()) * ChunkEntry::SIZE);
+            file.read(reinterpret_cast<char*>(index.data()), index.size());
+            if(!file) return false;
+
+            file.seekg(0, std::ios::end);
+            const std::uintmax_t fileSize = std::uintmax_t(file.tellg());
+
+            // The table is checked against the header here,
+            // each chunk is checked against the table as it's read
+            RawIntType sum = ChecksumNumber(ChecksumNumber(CHECKSUM_START, length), height);
+            table.resize(getChunkCount());
+            for(RawIntType i = 0; i < table.size(); ++i)
+            {
+                const Byte* entry = &index[i * ChunkEntry::SIZE];
+                table[i].offset = ReadNumber(&entry[0]);
+                table[i].size = ReadNumber(&entry[4]);
+                table[i].checksum = ReadNumber(&entry[8]);
+                if(std::uintmax_t(table[i].offset) + table[i].size > fileSize) return false;
+
+                sum = ChecksumNumber(sum, table[i].checksum);
+            }
+
+            return sum == checksum;
+        }
+
+        bool readV1(const RawIntType chunk, GameType* cells, std::size_t count)
+        {
+            file.clear();
+            file.seekg(std::streamoff(sizeof(HeaderData)) + std::streamoff(chunk) * CHUNK_WIDTH * height);
+            file.read(reinterpret_cast<char*>(cells), count);
+            return bool(file);
+        }
+
+        bool readV2(const RawIntType chunk, GameType* cells, std::size_t count)
+        {
+            if(chunk >= table.size()) return false;
+            const ChunkEntry& entry = table[chunk];
+            packed.resize(entry.size);
+
+            file.clear();
+            file.seekg(entry.offset);
+            file.read(reinterpret_cast<char*>(packed.data()), packed.size());
+            if(!file) return false;
+
+            RawIntType sum = 0;
+            return DecodeChunk(packed.data(), packed.data() + packed.size(), cells, count, height, sum)
+                && sum == entry.checksum;
+        }
+
+        std::ifstream file;
+        RawIntType version = 0, height = 0, length = 0, coins = 0, checksum = 0;
+        std::vector<ChunkEntry> table;
+        std::vector<Byte> packed; // Reused for every chunk read
+    };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,116 @@
+#ifndef FIXED_STEP_H
+#define FIXED_STEP_H
+
+#include "Constants.h"
+
+#include <ostream> // Timing report
+
+// Decides how many game ticks to run each drawn frame, so the game runs
+// at exactly GAME_FPS whatever the display does. Time builds up between
+// frames and is spent a tick at a time. After a long stall anything past
+// MAX_CATCH_UP_TICKS is dropped, so the game slows down for a moment
+// instead of running ahead in a burst. Times in the game count ticks,
+// not the wall clock, so they stay exact either way.
+class FixedStep
+{
+public:
+    using Duration = CHRONO_CLOCK::duration;
+    static constexpr Duration TICK = Duration(std::chrono::seconds(1)) / GAME_FPS;
+
+    // Running totals, in milliseconds
+    struct Timing
+    {
+        std::uintmax_t count = 0;
+        double last = 0, total = 0, worst = 0;
+
+        void add(double milliseconds)
+        {
+            ++count;
+            last = milliseconds;
+            total += milliseconds;
+            worst = std::max(worst, milliseconds);
+        }
+
+        double average() const { return count ? total / count : 0; }
+    };
+
+    // Call once per drawn frame, returns how many ticks to run.
+    // Nothing builds up while the game isn't running.
+    IntType advance(bool running)
+    {
+        const CHRONO_CLOCK::time_point now = CHRONO_CLOCK::now();
+        const Duration elapsed = started ? now - lastFrame : Duration::zero();
+        if(started) frames.add(Milliseconds(elapsed));
+        lastFrame = now;
+        started = true;
+
+        if(!running)
+        {
+            accumulated = Duration::zero();
+            return 0;
+        }
+
+        accumulated += elapsed;
+        IntType ticks = IntType(accumulated / TICK);
+        if(ticks > MAX_CATCH_UP_TICKS)
+        {
+            droppedTicks += ticks - MAX_CATCH_UP_TICKS;
+            ticks = MAX_CATCH_UP_TICKS;
+            accumulated = accumulated % TICK;
+        } else accumulated -= ticks * TICK;
+
+        return ticks;
+    }
+
+    // Forget time spent away from the game, like in the editor
+    void reset()
+    {
+        started = false;
+        accumulated = Duration::zero();
+    }
+
+    // How far into the next tick this frame is drawn, from 0 to 1
+    double alpha() const
+    {
+        return std::chrono::duration<double>(accumulated) / TICK;
+    }
+
+    // Times one game tick
+    class TickTimer
+    {
+    public:
+        explicit TickTimer(FixedStep& inStep) : step(inStep), start(CHRONO_CLOCK::now()) {}
+        ~TickTimer() { step.ticks.add(Milliseconds(CHRONO_CLOCK::now() - start)); }
+
+    private:
+        FixedStep& step;
+        CHRONO_CLOCK::time_point start;
+    };
+
+    const Timing& getFrameTiming() const { return frames; }
+    const Timing& getTickTiming() const { return ticks; }
+    std::uintmax_t getDroppedTicks() const { return droppedTicks; }
+
+    void report(std::ostream& out) const
+    {
+        out << "Frames: " << frames.count << ", " << frames.average() << "ms average, "
+            << frames.worst << "ms worst\n"
+            << "Ticks: " << ticks.count << ", " << ticks.average() << "ms average, "
+            << ticks.worst << "ms worst, " << droppedTicks << " dropped\n";
+    }
+
+private:
+    static double Milliseconds(Duration time)
+    {
+        return std::chrono::duration<double, std::milli>(time).count();
+    }
+
+    bool started = false;
+    CHRONO_CLOCK::time_point lastFrame;
+    Duration accumulated = Duration::zero();
+
+    Timing frames, ticks;
+    std::uintmax_t droppedTicks = 0;
+};
+
+#endif // FIXED_STEP_H
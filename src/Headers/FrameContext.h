@@ -0,0 +1,77 @@
+#ifndef FRAME_CONTEXT_H
+#define FRAME_CONTEXT_H
+
+#include "Constants.h"
+
+/*************************/
+/***** CLOCK SOURCES *****/
+/*************************/
+
+// Where the global frame count comes from
+class FrameClock
+{
+public:
+    virtual ~FrameClock() {}
+    virtual IntType read() = 0;
+};
+
+// Wall clock at GAME_FPS, what the game window uses
+class SteadyFrameClock : public FrameClock
+{
+public:
+    IntType read() override { return GET_GLOBAL_FRAME(); }
+};
+
+// Counts up by a fixed step every read, so runs without a
+// window animate the same way every time
+class SyntheticFrameClock : public FrameClock
+{
+public:
+    explicit SyntheticFrameClock(IntType start = 0, IntType inStep = 1)
+        : next(start), step(inStep) {}
+
+    IntType read() override
+    {
+        const IntType out = next;
+        next += step;
+        return out;
+    }
+
+private:
+    IntType next, step;
+};
+
+/*************************/
+/***** FRAME CONTEXT *****/
+/*************************/
+
+// Everything about "now" that drawing a frame needs, read once at the
+// top of the frame so every pixel sees the same animation phase. Each
+// thread has its own clock and frame, so tools can run a game per thread.
+class FrameContext
+{
+public:
+    IntType globalFrame = 0;
+
+    // Call once per frame before updating or drawing anything
+    static const FrameContext& Capture()
+    {
+        current.globalFrame = clock->read();
+        return current;
+    }
+
+    static const FrameContext& Get() { return current; }
+
+    // The clock has to outlive every frame that uses it
+    static void SetClock(FrameClock& inClock) { clock = &inClock; }
+    static void UseSteadyClock() { clock = &steady; }
+
+private:
+    static inline SteadyFrameClock steady;
+    static inline thread_local FrameClock* clock = &steady;
+    static thread_local FrameContext current;
+};
+
+inline thread_local FrameContext FrameContext::current;
+
+#endif // FRAME_CONTEXT_H
@@ -5,6 +5,16 @@
 #include "NumberLookup.h"
 #include "Constants.h"
 #include "FileLoader.h"
+#include "World.h"
+#include "Input.h"
+#include "Pixels.h"
+#include "Noise.h"
+#include "FrameContext.h"
+#include "LevelIndex.h"
+#include "LevelCache.h"
+#include "Profiler.h"
+
+#include <array> // Type table
 
 class Game
 {
@@ -33,13 +43,14 @@ public: // Static methods and enums
     struct GameTypeData
     {
         const char* name; // block name
-        sf::Color color; // block color
+        GameColor color; // block color
         IntType randomness; // randomness of block color
         double cameraSpeed; // paralax
         double textureSpeed; // how fast block color moves
         TypePropsType propertys; // game properties
 
         bool getProp(TypePropsType) const;
+        double texturePhase(IntType) const;
         IntType randomize(IntType, IntType, IntType) const;
     };
 
@@ -47,35 +58,78 @@ public: // Static methods and enums
     static const GameTypeLink GameTypeList[GameTypeCount];
     static const GameTypeData GetTypeData(GameType);
 
+    // The part of GameTypeData used every tick and every pixel,
+    // kept small so all 256 IDs fit in a few cache lines
+    static constexpr Byte UNKNOWN_TYPE = 0xff;
+    struct GameTypeHot
+    {
+        TypePropsType propertys; // game properties
+        GameColor color; // block color
+        Byte index; // position in GameTypeList, UNKNOWN_TYPE if none
+        IntType randomness; // randomness of block color
+
+        bool getProp(TypePropsType) const;
+        IntType randomize(IntType, IntType, IntType) const;
+        IntType texture(double, IntType, IntType) const;
+    };
+
+    // Indexed directly by GameType
+    static const std::array<GameTypeHot, 0x100> GameTypeTable;
+    static const GameTypeHot& GetTypeHot(GameType);
+
+    // Every type's texture, worked out the first time it's needed
+    static const Noise::Field& GetNoise();
+
     enum GravityType : IntType { Up = -1, Down = 1 };
 
-    static void loadBufferFromFile(sf::SoundBuffer&, const std::string&);
+    // The game never touches the audio device, it only reports
+    // what should be heard this tick and lets a front end play it
+    enum SoundEvents : SoundEventType
+    {
+        NoSound     = 0x00, // Silence
+        PlayCoin    = SoundEventBit(0), // Picked up a coin
+        PlayJump    = SoundEventBit(1), // Jumped off of a block
+        PlayBounce  = SoundEventBit(2), // Bounced off of a block
+        PlayDeath   = SoundEventBit(3), // Died
+        PlayWin     = SoundEventBit(4), // Reached the goal
+        ToggleSound = SoundEventBit(5), // Sound effects turned on/off
+        ToggleMusic = SoundEventBit(6)  // Music turned on/off
+    };
 
 public:
     Game();
 
-    // Controls
-    static bool isJoystickConnected();
-    static float joyXAxis();
-    static float joyYAxis();
-
-    static bool resetKey();
+private: // Controls, read from the input of the current tick
+    bool resetKey() const;
+    bool upKey() const;
+    bool downKey() const;
+    bool leftKey() const;
+    bool rightKey() const;
+    bool jumpKey() const;
+
+    // Cheats toggle once per key press
+    bool flyCheatKey() const;
+    bool levelCheatKey() const;
+    bool soundKey() const;
+    bool musicKey() const;
+    bool pressed(InputType) const;
 
-    static bool upKey();
-    static bool downKey();
-    static bool leftKey();
-    static bool rightKey();
-    static bool jumpKey(GravityType);
+public: // Game Loop
+    void gameLoop(const Input::State&);
 
-    static bool cheatKey();
-    static bool flyCheatKey();
-    static bool levelCheatKey();
-    static bool editorCheatKey();
-    static bool soundKey();
-    static bool musicKey();
+    // Everything about the player that carries from one tick to the
+    // next, so a search can go back to a tick it has already played
+    struct PlayerState
+    {
+        sf::Vector2<IntType> player;
+        IntType trapX;
+        RawIntType rawFrame;
+        GravityType gravity;
+        bool canJump, canBounce;
+    };
 
-public: // Game Loop
-    void gameLoop();
+    PlayerState getPlayerState() const;
+    void setPlayerState(const PlayerState&);
 
 private: // Subunits of Game Loop
     void resetKeyLoop();
@@ -93,14 +147,35 @@ private: // Subunits of Game Loop
     void reset();
 
 public: // World/Rendering
+    // Camera and player part way between the last tick and this one
+    struct View
+    {
+        double cameraX, cameraY;
+        double playerX, playerY;
+        sf::Color player; // Shaded like the rest of the screen
+    };
+
     IntType loadWorld(const IntType);
-    const Byte* returnWorldPixels(bool);
+    const Byte* returnWorldPixels(bool, bool = true);
+    View getView(double, bool) const;
+    void invalidateRender();
     HashType updateLevelHash();
 
+private: // Subunits of rendering
+    using ColumnMask = std::uint64_t;
+    static_assert(GAME_WIDTH <= 64, "ColumnMask needs a bit for every column");
+    static constexpr ColumnMask ColumnBit(IntType x) { return ColumnMask(0x1) << x; }
+
+    void renderBase(IntType, IntType, bool, bool);
+    void markDirty(IntType, IntType);
+    static double Interpolate(IntType, IntType, double);
+
 public: // Getters
-    void setSound(bool);
+    SoundEventType getSoundEvents() const;
+    bool getLowGravity() const;
 
     IntType getCameraX() const;
+    IntType getCameraY() const;
 
     IntType getLevel() const;
     IntType getFinalLevel() const;
@@ -116,53 +191,197 @@ public: // Getters
     IntType getFrame() const;
     IntType getLevelFrame(IntType) const;
 
+    IntType getLevelLength() const;
+    IntType getLevelHeight() const;
     GameType getWorld(IntType, IntType) const;
     GameType& getWorldRef(IntType, IntType);
-    GameTypeData getWorldData(IntType, IntType) const;
-    GameTypeData getPlayerData(IntType = 0, IntType = 0) const;
+    const GameTypeHot& getWorldData(IntType, IntType) const;
+    const GameTypeHot& getPlayerData(IntType = 0, IntType = 0) const;
 
     bool getWinner() const;
     bool getCheater() const;
     bool getFlying() const;
     void setCheater();
 
-public: // Sounds
-    sf::SoundBuffer coinBuffer;
-    sf::Sound coinSound;
-
-    sf::SoundBuffer jumpBuffer;
-    sf::Sound jumpSound;
-
-    sf::SoundBuffer bounceBuffer;
-    sf::Sound bounceSound;
-
-    sf::SoundBuffer deathBuffer;
-    sf::Sound deathSound;
-
-    sf::SoundBuffer winBuffer;
-    sf::Sound winSound;
-
-    sf::Music overworldMusic;
-
 private: // Member Variables
-    HashType hash, maxCoins;
+    LevelIndex levels; // Hash and coins of every level file
+    LevelCache cache; // Levels already read, and the next one on its way
+    HashType hash = 0; // Level hash this run was checked against
     RawIntType rawFrame; // Used for game mechanics, always ticks
-    IntType finalLevel; // Used to count number of levels
+    IntType finalLevel = 0; // Used to count number of levels
     IntType level, frame, deaths, coins;
     IntType levelFrames[MAX_LEVEL_COUNT];
     IntType levelCoins[MAX_LEVEL_COUNT];
-    IntType levelMaxCoins[MAX_LEVEL_COUNT];
 
     sf::Vector2<IntType> player; 
-    IntType cameraX, trapX;
+    IntType cameraX, cameraY, trapX;
+
+    // Where the last tick left them, for drawing between ticks
+    sf::Vector2<IntType> lastPlayer;
+    IntType lastCameraX = 0, lastCameraY = 0;
     
     GravityType gravity = GravityType::Down; 
     bool canJump = true, canBounce = true;
     bool hasCheated = false, enableFly = false;
-    bool playSounds = true;
 
-    GameType world[GAME_LENGTH][GAME_HEIGHT];
+    Input::State input, lastInput;
+    SoundEventType soundEvents = SoundEvents::NoSound;
+
+    World world; // Current level, paged in around the camera
     Byte buffer[GAME_HEIGHT][GAME_WIDTH][4];
+
+    // What buffer was last drawn with, so only changes get redrawn
+    struct RenderCache
+    {
+        bool valid = false, focus = true, smog = false;
+        IntType cameraX = 0, cameraY = 0, trapX = 0, smogOffset = 0;
+        sf::Vector2<IntType> player;
+        double phase[GameTypeCount] = {};
+        ColumnMask dirtyRows[GAME_HEIGHT] = {};
+        Pixels::Row base[GAME_HEIGHT];
+    } render;
+};
+
+// Game types and their properties
+/* ***** TYPE DATA STRUCTURE *****
+ * GameType::XXXXX, <--- Game Type
+ * {"[Block Name]", [Block Color], [1*], [2*], [3*],
+ *      [Type Propertys] | [Type Propertys]
+ * }
+ * 
+ * 1* = Texture Randomness
+ * 2* = How Fast Texture Moves With Camera (Paralax)
+ * 3* = How Fast Texture Moves On Its Own
+ */ 
+inline constexpr Game::GameTypeLink Game::GameTypeList[GameTypeCount] = {
+    {
+        GameType::Sky, 
+        {"Sky", {0, 160, 200}, 8, 1.0/3.0, 1.0/GAME_FPS,
+            TypeProps::None
+        }
+    }, {
+        GameType::Ground, 
+        {"Ground", {52, 52, 52}, 24, 1.0, 0.0,
+            TypeProps::Solid | TypeProps::Jumpable 
+        }
+    }, {
+        GameType::Trap, 
+        {"Trap", {220, 32, 0}, 32, 0.0, 0,
+            TypeProps::Trap
+        }
+    }, {
+        GameType::Bounce, 
+        {"Bounce", {64, 255, 164}, 0, 0.0, 0.0,
+            TypeProps::Bounce
+        }
+    }, {
+        GameType::Mud, 
+        {"Mud", {130, 60, 10}, -12, 1.0, 0.0,
+            TypeProps::Solid | TypeProps::Slow
+        }
+    }, {
+        GameType::Water, 
+        {"Water", {0, 64, 255}, 8, -1.0/2.0, 0.1,
+            TypeProps::LowGravity | TypeProps::Jumpable
+        }
+    }, {
+        GameType::Smog, 
+        {"Smog", {128, 128, 128}, 8, 1.0/6.0, 0.5/GAME_FPS,
+            TypeProps::Smog | TypeProps::StopStorm
+        }
+    }, {
+        GameType::LowGravity, 
+        {"Low Gravity", {100, 0, 100}, 8, 1.0/3.0, 1.0/GAME_FPS,
+            TypeProps::LowGravity
+        }
+    }, {
+        GameType::MoveRight, 
+        {"Move Right", {64, 196, 0}, 64, 1, 4.0/9.0,
+            TypeProps::MoveRight | TypeProps::StopStorm
+        }
+    }, {
+        GameType::MoveLeft, 
+        {"Move Left", {64, 196, 0}, 64, 1, -4.0/9.0,
+            TypeProps::MoveLeft | TypeProps::StopStorm
+        }
+    }, {
+        GameType::Honey, 
+        {"Honey", {192, 128, 16}, 16, 1.0/3.0, 1.0/GAME_FPS,
+            TypeProps::Slow | TypeProps::LowGravity
+        }
+    }, {
+        GameType::Coin, 
+        {"Coin", {255, 200, 16}, 56, 0, 4.0/GAME_FPS,
+            TypeProps::Coin
+        }
+    }, {
+        GameType::Goal, 
+        {"Goal", {196, 255, 16}, 0, 0.0, 0.0,
+            TypeProps::Goal
+        }
+    }
 };
 
+constexpr std::array<Game::GameTypeHot, 0x100> BuildGameTypeTable()
+{
+    // IDs not in the list are marked unknown
+    std::array<Game::GameTypeHot, 0x100> table{};
+    for(Game::GameTypeHot& entry : table)
+        entry = {Game::TypeProps::None, {0, 0, 0}, Game::UNKNOWN_TYPE, 0};
+
+    for(IntType i = 0; i < GameTypeCount; ++i)
+    {
+        const Game::GameTypeData& data = Game::GameTypeList[i].data;
+        table[Game::GameTypeList[i].type] = {data.propertys, data.color, Byte(i), data.randomness};
+    }
+
+    return table;
+}
+
+inline constexpr std::array<Game::GameTypeHot, 0x100> Game::GameTypeTable = BuildGameTypeTable();
+
+inline Noise::Field::TypeRandomness BuildNoiseRandomness()
+{
+    Noise::Field::TypeRandomness randomness{};
+    for(IntType i = 0; i < GameTypeCount; ++i)
+        randomness[i] = Game::GameTypeList[i].data.randomness;
+    return randomness;
+}
+
+inline const Game::GameTypeHot& Game::GetTypeHot(GameType input)
+{
+    const GameTypeHot& entry = GameTypeTable[input];
+    if(entry.index != UNKNOWN_TYPE) return entry;
+    
+    // Unknown blocks act like a random block every frame
+    return GameTypeTable[GameTypeList[RANDOMIZE(FrameContext::Get().globalFrame)%GameTypeCount].type];
+}
+
+inline bool Game::GameTypeHot::getProp(TypePropsType prop) const
+{
+    return (propertys & prop) != 0;
+}
+
+inline const Noise::Field& Game::GetNoise()
+{
+    static const Noise::Field field(BuildNoiseRandomness());
+    return field;
+}
+
+inline IntType Game::GameTypeHot::randomize(IntType cx, IntType x, IntType y) const
+{
+    if(randomness != 0) return texture(GameTypeList[index].data.texturePhase(cx), x, y);
+    return IntType(0);
+}
+
+// Same as randomize() with the phase already worked out for this frame
+inline IntType Game::GameTypeHot::texture(double phase, IntType x, IntType y) const
+{
+    if(randomness == 0) return IntType(0);
+
+    const IntType XRand = 1 + x + phase;
+    if(Noise::Field::IsExact()) return Noise::Field::Exact(randomness, XRand, 1 + y);
+    return GetNoise().sample(index, XRand, y);
+}
+
 #endif // GAME_H
@@ -0,0 +1,402 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "./Constants.h"
+
+#include <bitset> // Held keys
+#include <vector> // Press times
+
+namespace Input
+{
+    // Everything the simulation reads from the player in one tick
+    enum Button : InputType
+    {
+        None        = 0x00, // Blank
+        Up          = InputBit(0), // W / Up Arrow / Joystick Up
+        Down        = InputBit(1), // S / Down Arrow / Joystick Down
+        Left        = InputBit(2), // A / Left Arrow / Joystick Left
+        Right       = InputBit(3), // D / Right Arrow / Joystick Right
+        Jump        = InputBit(4), // Space Bar / Jump Buttons
+        Reset       = InputBit(5), // Escape / Reset Button
+        Fly         = InputBit(6), // Ctrl + Shift + F
+        SkipLevel   = InputBit(7), // Ctrl + Shift + L
+        Editor      = InputBit(8), // Ctrl + Shift + E
+        ToggleSound = InputBit(9), // Ctrl + Shift + S
+        ToggleMusic = InputBit(10) // Ctrl + Shift + M
+    };
+
+    struct State
+    {
+        InputType buttons = Button::None;
+
+        // This allows for testing of more than
+        // One button at a time
+        bool get(InputType button) const { return (buttons & button) != 0; }
+        void set(InputType button, bool value)
+        {
+            if(value) buttons |= button;
+            else buttons &= ~button;
+        }
+    };
+
+    // Anything that can feed the game loop
+    class Source
+    {
+    public:
+        virtual ~Source() {}
+        virtual State poll() = 0;
+    };
+
+    /**************************/
+    /***** DEVICE SNAPSHOT ****/
+    /**************************/
+
+    // Keyboard, mouse and joystick as they were over one tick. Built from
+    // window events, so reading it never asks the OS anything, and it
+    // doesn't change while the tick reads it.
+    struct Snapshot
+    {
+        using Keys = std::bitset<sf::Keyboard::KeyCount>;
+        using Buttons = std::bitset<sf::Joystick::ButtonCount>;
+        using MouseButtons = std::bitset<sf::Mouse::ButtonCount>;
+
+        Keys held, pressedKeys, releasedKeys, typedKeys;
+        Buttons joystickHeld, joystickPressed;
+        float axes[sf::Joystick::AxisCount] = {};
+
+        MouseButtons mouseHeld;
+        sf::Vector2i mousePosition;
+        bool mouseInside = false;
+
+        // When each press of a movement, jump or reset key or button in this
+        // snapshot came out of the window's event queue, for measuring latency
+        std::vector<CHRONO_CLOCK::time_point> pressTimes;
+
+        // Down at any point this tick, so a tap between ticks still counts
+        bool down(sf::Keyboard::Key key) const { return Valid(key) && (held[key] || pressedKeys[key]); }
+
+        // Went down or came up since the last tick
+        bool pressed(sf::Keyboard::Key key) const { return Valid(key) && pressedKeys[key]; }
+        bool released(sf::Keyboard::Key key) const { return Valid(key) && releasedKeys[key]; }
+
+        // Pressed, or repeated by the OS while held, for counting key presses
+        bool typed(sf::Keyboard::Key key) const { return Valid(key) && typedKeys[key]; }
+
+        bool button(IntType id) const { return joystickHeld[id] || joystickPressed[id]; }
+        float axis(sf::Joystick::Axis id) const { return axes[id]; }
+        bool mouse(sf::Mouse::Button id) const { return mouseHeld[id]; }
+
+        static bool Valid(sf::Keyboard::Key key)
+        {
+            return key >= 0 && key < sf::Keyboard::KeyCount;
+        }
+    };
+
+    // Keeps track of the devices from window events, every event the
+    // window gets goes through handle()
+    class Tracker
+    {
+    public:
+        void handle(const sf::Event& event)
+        {
+            switch(event.type)
+            {
+            case sf::Event::KeyPressed:
+                if(!Snapshot::Valid(event.key.code)) break;
+                if(!next.held[event.key.code])
+                {
+                    next.pressedKeys.set(event.key.code);
+                    if(!event.key.control && !event.key.shift && PlayKey(event.key.code))
+                        next.pressTimes.push_back(CHRONO_CLOCK::now());
+                }
+                next.held.set(event.key.code);
+                next.typedKeys.set(event.key.code);
+                break;
+
+            case sf::Event::KeyReleased:
+                if(!Snapshot::Valid(event.key.code)) break;
+                if(next.held[event.key.code]) next.releasedKeys.set(event.key.code);
+                next.held.reset(event.key.code);
+                ignored.reset(event.key.code);
+                break;
+
+            case sf::Event::JoystickButtonPressed:
+                if(IntType(event.joystickButton.joystickId) != DEFAULT_JOYSTICK_PORT
+                || event.joystickButton.button >= sf::Joystick::ButtonCount) break;
+                next.joystickHeld.set(event.joystickButton.button);
+                next.joystickPressed.set(event.joystickButton.button);
+                if(PlayButton(event.joystickButton.button)) next.pressTimes.push_back(CHRONO_CLOCK::now());
+                break;
+
+            case sf::Event::JoystickButtonReleased:
+                if(IntType(event.joystickButton.joystickId) != DEFAULT_JOYSTICK_PORT
+                || event.joystickButton.button >= sf::Joystick::ButtonCount) break;
+                next.joystickHeld.reset(event.joystickButton.button);
+                break;
+
+            case sf::Event::JoystickMoved:
+                if(IntType(event.joystickMove.joystickId) != DEFAULT_JOYSTICK_PORT) break;
+                next.axes[event.joystickMove.axis] = event.joystickMove.position;
+                break;
+
+            case sf::Event::JoystickDisconnected:
+                if(IntType(event.joystickConnect.joystickId) != DEFAULT_JOYSTICK_PORT) break;
+                next.joystickHeld.reset();
+                for(float& axis : next.axes) axis = 0;
+                break;
+
+            case sf::Event::MouseMoved:
+                next.mousePosition = sf::Vector2i(event.mouseMove.x, event.mouseMove.y);
+                next.mouseInside = true;
+                break;
+
+            case sf::Event::MouseLeft:
+                next.mouseInside = false;
+                break;
+
+            case sf::Event::MouseButtonPressed:
+                if(event.mouseButton.button >= sf::Mouse::ButtonCount) break;
+                next.mouseHeld.set(event.mouseButton.button);
+                next.mousePosition = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+                break;
+
+            case sf::Event::MouseButtonReleased:
+                if(event.mouseButton.button >= sf::Mouse::ButtonCount) break;
+                next.mouseHeld.reset(event.mouseButton.button);
+                break;
+
+            // Nothing gets released while the window can't see it
+            case sf::Event::LostFocus:
+                next.releasedKeys |= next.held;
+                next.held.reset();
+                next.joystickHeld.reset();
+                next.mouseHeld.reset();
+                ignored.reset();
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        // Everything since the last snapshot, edges start again after this
+        Snapshot snapshot()
+        {
+            Snapshot out = next;
+            out.held &= ~ignored;
+            out.typedKeys &= ~ignored;
+
+            next.pressedKeys.reset();
+            next.releasedKeys.reset();
+            next.typedKeys.reset();
+            next.joystickPressed.reset();
+            next.pressTimes.clear();
+            return out;
+        }
+
+        // Keys held right now read as up until they're let go, so a key
+        // that left one screen doesn't do something on the next
+        void ignoreHeld()
+        {
+            ignored = next.held;
+        }
+
+    private:
+        // Presses that move the player or restart, anything else
+        // doesn't change the screen so isn't timed
+        static bool PlayKey(sf::Keyboard::Key key)
+        {
+            switch(key)
+            {
+            case sf::Keyboard::Up: case sf::Keyboard::W:
+            case sf::Keyboard::Down: case sf::Keyboard::S:
+            case sf::Keyboard::Left: case sf::Keyboard::A:
+            case sf::Keyboard::Right: case sf::Keyboard::D:
+            case sf::Keyboard::Space: case sf::Keyboard::Escape:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        static bool PlayButton(unsigned int button)
+        {
+            for(auto ID : JUMP_BUTTONS)
+                if(IntType(button) == ID) return true;
+            return IntType(button) == RESET_BUTTON;
+        }
+
+        Snapshot next;
+        Snapshot::Keys ignored;
+    };
+
+    /************************/
+    /***** LIVE CONTROLS ****/
+    /************************/
+
+    static float joyXAxis(const Snapshot& in)
+    {
+        return in.axis(sf::Joystick::X) + in.axis(sf::Joystick::PovX);
+    }
+
+    static float joyYAxis(const Snapshot& in)
+    {
+        return in.axis(sf::Joystick::Y) + in.axis(sf::Joystick::PovY);
+    }
+
+    static bool cheatKey(const Snapshot& in)
+    {
+        return in.down(sf::Keyboard::LControl)
+            && in.down(sf::Keyboard::LShift);
+    }
+
+    static bool resetKey(const Snapshot& in)
+    {
+        return in.down(sf::Keyboard::Escape)
+            || in.button(RESET_BUTTON);
+    }
+
+    static bool upKey(const Snapshot& in)
+    {
+        return (in.down(sf::Keyboard::Up)
+             || in.down(sf::Keyboard::W)
+             || joyYAxis(in) < -Y_JOYSTICK_DEAD_ZONE) && !cheatKey(in);
+    }
+
+    static bool downKey(const Snapshot& in)
+    {
+        return (in.down(sf::Keyboard::Down)
+             || in.down(sf::Keyboard::S)
+             || joyYAxis(in) > Y_JOYSTICK_DEAD_ZONE) && !cheatKey(in);
+    }
+
+    static bool leftKey(const Snapshot& in)
+    {
+        return (in.down(sf::Keyboard::Left)
+             || in.down(sf::Keyboard::A)
+             || joyXAxis(in) < -X_JOYSTICK_DEAD_ZONE) && !cheatKey(in);
+    }
+
+    static bool rightKey(const Snapshot& in)
+    {
+        return (in.down(sf::Keyboard::Right)
+             || in.down(sf::Keyboard::D)
+             || joyXAxis(in) > X_JOYSTICK_DEAD_ZONE) && !cheatKey(in);
+    }
+
+    // Up and Down also jump, but that depends on gravity
+    // So the game works that part out itself
+    static bool jumpKey(const Snapshot& in)
+    {
+        for(auto ID : JUMP_BUTTONS)
+            if(in.button(ID))
+                return true;
+
+        return in.down(sf::Keyboard::Space);
+    }
+
+    static bool flyCheatKey(const Snapshot& in)
+    {
+        return cheatKey(in) && in.down(sf::Keyboard::F);
+    }
+
+    static bool levelCheatKey(const Snapshot& in)
+    {
+        return cheatKey(in) && in.down(sf::Keyboard::L);
+    }
+
+    static bool editorCheatKey(const Snapshot& in)
+    {
+        return cheatKey(in) && in.down(sf::Keyboard::E);
+    }
+
+    static bool soundKey(const Snapshot& in)
+    {
+        return cheatKey(in) && in.down(sf::Keyboard::S);
+    }
+
+    static bool musicKey(const Snapshot& in)
+    {
+        return cheatKey(in) && in.down(sf::Keyboard::M);
+    }
+
+    // The buttons the game reads, out of everything on the devices
+    static State ReadState(const Snapshot& in)
+    {
+        State state;
+        state.set(Button::Up, upKey(in));
+        state.set(Button::Down, downKey(in));
+        state.set(Button::Left, leftKey(in));
+        state.set(Button::Right, rightKey(in));
+        state.set(Button::Jump, jumpKey(in));
+        state.set(Button::Reset, resetKey(in));
+        state.set(Button::Fly, flyCheatKey(in));
+        state.set(Button::SkipLevel, levelCheatKey(in));
+        state.set(Button::Editor, editorCheatKey(in));
+        state.set(Button::ToggleSound, soundKey(in));
+        state.set(Button::ToggleMusic, musicKey(in));
+        return state;
+    }
+
+    /*******************/
+    /***** SOURCES *****/
+    /*******************/
+
+    // Keyboard and joystick of the machine running the game,
+    // one snapshot of the window's events per tick
+    class Live : public Source
+    {
+    public:
+        explicit Live(Tracker& inTracker) : tracker(inTracker) {}
+
+        State poll() override
+        {
+            last = tracker.snapshot();
+            return ReadState(last);
+        }
+
+        // What the last poll() read
+        const Snapshot& getSnapshot() const { return last; }
+
+    private:
+        Tracker& tracker;
+        Snapshot last;
+    };
+
+    // Nobody at the controls
+    class Idle : public Source
+    {
+    public:
+        State poll() override { return State(); }
+    };
+
+    // Seeded bot for automated playtesting, mostly runs right and jumps
+    class Random : public Source
+    {
+    public:
+        explicit Random(IntType inSeed) : seed(inSeed), held(0) {}
+
+        State poll() override
+        {
+            // Hold each choice for a few ticks like a person would
+            if(held <= 0)
+            {
+                const IntType roll = RANDOMIZE(seed++);
+                current.buttons = Button::None;
+                current.set(Button::Right, roll % 4 != 0);
+                current.set(Button::Left, roll % 8 == 0);
+                current.set(Button::Jump, (roll / 8) % 3 == 0);
+                held = 1 + (roll / 24) % 6;
+            }
+
+            --held;
+            return current;
+        }
+
+    private:
+        IntType seed, held;
+        State current;
+    };
+}
+
+#endif // INPUT_H
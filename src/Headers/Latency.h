@@ -0,0 +1,67 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "Constants.h"
+#include "Input.h"
+
+#include <algorithm> // Sorting samples
+#include <ostream> // Latency report
+#include <vector> // Samples
+
+namespace Input
+{
+    // Time from a press coming out of the event queue to the end of the
+    // first app.display() after a tick read it. Presses wait for the next
+    // tick, so this covers the tick rate, the game loop and drawing.
+    class Latency
+    {
+    public:
+        // Presses the tick that just ran could see
+        void read(const Snapshot& snapshot)
+        {
+            waiting.insert(waiting.end(), snapshot.pressTimes.begin(), snapshot.pressTimes.end());
+        }
+
+        // Call straight after the frame is shown
+        void displayed()
+        {
+            if(waiting.empty()) return;
+
+            const CHRONO_CLOCK::time_point now = CHRONO_CLOCK::now();
+            for(const CHRONO_CLOCK::time_point& pressed : waiting)
+                samples.push_back(std::chrono::duration<double, std::milli>(now - pressed).count());
+            waiting.clear();
+        }
+
+        std::size_t getCount() const { return samples.size(); }
+
+        // Nearest rank, p from 0 to 100, in milliseconds
+        double percentile(double p) const
+        {
+            if(samples.empty()) return 0;
+
+            std::vector<double> sorted = samples;
+            const std::size_t rank = std::min(sorted.size() - 1,
+                std::size_t(std::max(std::ceil(p / 100 * sorted.size()), 1.0) - 1));
+            std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+            return sorted[rank];
+        }
+
+        void report(std::ostream& out) const
+        {
+            out << "Input latency: " << samples.size() << " presses";
+            if(!samples.empty())
+            {
+                out << ", p50 " << percentile(50) << "ms, p90 " << percentile(90)
+                    << "ms, p99 " << percentile(99) << "ms, max " << percentile(100) << "ms";
+            }
+            out << '\n';
+        }
+
+    private:
+        std::vector<CHRONO_CLOCK::time_point> waiting;
+        std::vector<double> samples;
+    };
+}
+
+#endif // LATENCY_H
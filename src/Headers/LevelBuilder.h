@@ -5,26 +5,59 @@
 #include "./Window.h"
 #include "./Constants.h"
 #include "./Game.h"
-#include "./FileLoader.h"
+#include "./World.h"
+#include "./Input.h"
+#include "./Pixels.h"
+#include "./FrameContext.h"
+#include "./Assets.h"
+#include "./LevelSaver.h"
+
+#include <filesystem> // Finding autosaves
+#include <thread> // Sleeping while idle
 
 namespace LevelBuilder
 {
-    static void updateBuffer(Byte buffer[][GAME_WIDTH][4], const GameType world[][GAME_HEIGHT], 
-                             IntType cameraX, GameType userItem, sf::Vector2i mousePos)
+    // Blocks that look different from one frame to the next
+    static bool IsAnimated(GameType block)
+    {
+        static const std::array<bool, 0x100> animated = []()
+        {
+            std::array<bool, 0x100> out{};
+            for(IntType i = 0; i < 0x100; ++i)
+            {
+                const Game::GameTypeHot& hot = Game::GameTypeTable[i];
+                out[i] = hot.index == Game::UNKNOWN_TYPE
+                      || (hot.randomness != 0 && Game::GameTypeList[hot.index].data.textureSpeed != 0);
+            }
+            return out;
+        }();
+        return animated[block];
+    }
+
+    // Returns true if anything drawn is animated
+    static bool updateBuffer(Byte buffer[][GAME_WIDTH][4], const World& world, 
+                             IntType cameraX, IntType cameraY, GameType userItem, sf::Vector2i mousePos)
     {
-        for(IntType y = 0; y < GAME_HEIGHT; y++)
+        PROFILE_SCOPE("updateBuffer");
+        bool animated = false;
+        world.prefetch(cameraX, cameraX + GAME_WIDTH);
+        const Pixels::Shade shade = Pixels::Shade::Make(cameraX);
+        Pixels::Row row;
+
+        for(IntType y = 0; y < IntType(GAME_HEIGHT); y++)
         {
             for(IntType x = 0; x < GAME_WIDTH; x++)
             {
                 // Current Pixel
-                GameType gamePixel = world[cameraX + x][y];
+                GameType gamePixel = world.get(cameraX + x, cameraY + y);
 
                 // Mouse Pointer
-                if(x + cameraX == mousePos.x && y == mousePos.y)
+                if(x + cameraX == mousePos.x && y + cameraY == mousePos.y)
                 { gamePixel = userItem; }
+                animated = animated || IsAnimated(gamePixel);
 
                 // Current Pixel
-                const Game::GameTypeData pixelData = Game::GetTypeData(gamePixel);
+                const Game::GameTypeHot& pixelData = Game::GetTypeHot(gamePixel);
 
                 // Values to feed into buffer
                 IntType R = pixelData.color.r; 
@@ -32,23 +65,23 @@ namespace LevelBuilder
                 IntType B = pixelData.color.b;
                 
                 // Randomize Color
-                IntType random = pixelData.randomize(cameraX, x, y);
+                IntType random = pixelData.randomize(cameraX, x, cameraY + y);
                 R += random; G += random; B += random;
-
-                // Start Area
-                if(x + cameraX <= START_SIZE) G += 48;
                 
                 // Mouse Pointer Highlight
-                if(x + cameraX == mousePos.x && y == mousePos.y)
+                if(x + cameraX == mousePos.x && y + cameraY == mousePos.y)
                 { R += 32; G += 32; B += 32; }
 
-                // Cap RGB Values
-                buffer[y][x][0] = static_cast<Byte>(std::max(std::min(R, IntType(255)), IntType(0))); // Red
-                buffer[y][x][1] = static_cast<Byte>(std::max(std::min(G, IntType(255)), IntType(0))); // Green
-                buffer[y][x][2] = static_cast<Byte>(std::max(std::min(B, IntType(255)), IntType(0))); // Blue
-                buffer[y][x][3] = 255; // Alpha
+                row.r[x] = R;
+                row.g[x] = G;
+                row.b[x] = B;
             }
+
+            // Start area and capping
+            Pixels::ShadeRow(row, shade, &buffer[y][0][0]);
         }
+
+        return animated;
     }
 
     static IntType LoopTypeIndex(IntType index)
@@ -71,9 +104,48 @@ namespace LevelBuilder
         GameType oldBlock;
     };
 
-    static IntType Loop(sf::RenderWindow &app, IntType level, IntType cameraX)
+    // Levels that don't exist yet start out blank
+    static void LoadSaved(World& world, IntType level)
+    {
+        if(!world.load(level)) world.blank();
+    }
+
+    // Same as LoadSaved(), but edits that were autosaved and never saved
+    // are picked up again, returns true if they were
+    static bool LoadWorld(World& world, IntType level)
+    {
+        const std::string autosave = Loader::AutosavePath(level);
+
+        // An autosave older than the level was saved over
+        std::error_code error;
+        const auto autosaveTime = std::filesystem::last_write_time(autosave, error);
+        if(!error)
+        {
+            const auto savedTime = std::filesystem::last_write_time(Loader::LevelPath(level), error);
+            if((error || autosaveTime >= savedTime) && world.loadEdits(level, autosave)) return true;
+        }
+
+        LoadSaved(world, level);
+        return false;
+    }
+
+    // Like sf::Window::waitEvent, but gives up at until. SFML 2.5 can't wait
+    // for an event with a timeout, so with one it checks every EDITOR_IDLE_TIME.
+    static bool WaitEvent(sf::RenderWindow &app, sf::Event &event, CHRONO_CLOCK::time_point until)
+    {
+        if(until == CHRONO_CLOCK::time_point::max()) return app.waitEvent(event);
+
+        while(!app.pollEvent(event))
+        {
+            const auto now = CHRONO_CLOCK::now();
+            if(now >= until) return false;
+            std::this_thread::sleep_for(std::min<CHRONO_CLOCK::duration>(until - now, EDITOR_IDLE_TIME));
+        }
+        return true;
+    }
+
+    static IntType Loop(sf::RenderWindow &app, Graphics::Renderer &renderer, Input::Tracker &tracker, IntType level, IntType cameraX, IntType cameraY)
     {
-        app.setFramerateLimit(60);
         sf::Text SavedIcon = GET_DEFAULT_TEXT(1);
         SavedIcon.setPosition((GAME_WIDTH-11)*GAME_SCALE,GAME_SCALE * (GAME_HEIGHT - 9));
 
@@ -89,6 +161,7 @@ namespace LevelBuilder
             "\n         Left Click = Place Block"
             "\n        Right Click = Copy Block"
             "\n       Left + Right = Move Camera" 
+            "\n PageUp + PageDown = Scroll Camera" 
             "\nCtrl + Left + Right = Change Level"    
         );
 
@@ -117,185 +190,329 @@ namespace LevelBuilder
         );
         
         std::stack<UndoData> undoList;
-        GameType world[GAME_LENGTH][GAME_HEIGHT] = {};
+        World world;
         Byte buffer[GAME_HEIGHT][GAME_WIDTH][4] = {};
-        IntType item = 0, frame = 0;
-        bool edits = false;
+        IntType item = 0;
+        bool edits = LoadWorld(world, level);
 
-        Loader::LoadWorld(level, world);
+        // Saves are written in the background, and unsaved edits
+        // are autosaved next to the level every EDITOR_AUTOSAVE_TIME
+        LevelSaver saver;
+        std::uintmax_t changes = 0, autosaved = 0, failures = 0;
+        auto nextAutosave = CHRONO_CLOCK::now() + EDITOR_AUTOSAVE_TIME;
+
+        // A save that didn't make it to disk leaves the level unsaved
+        const auto checkSaves = [&]()
+        {
+            if(saver.getFailures() == failures) return;
+            failures = saver.getFailures();
+            edits = true;
+        };
+
+        // What's on screen, it's only drawn again when something changes,
+        // or every EDITOR_ANIMATION_TIME while animated blocks are in view
+        IntType shownItem = -1, shownLevel = -1, shownCameraX = -1, shownCameraY = -1;
+        sf::Vector2i shownMouse(-1,-1);
+        bool shownEdits = false, shownSaving = false, shownAnimated = false, redraw = true;
+        auto nextAnimation = CHRONO_CLOCK::now();
+
+        // Something held that acts every frame, like moving the camera
+        bool active = false;
+        CHRONO_CLOCK::duration cameraTime = EDITOR_CAMERA_TIME; // Toward the next camera step
+        auto lastFrame = CHRONO_CLOCK::now();
+
+        // Nothing animates in the background, so an editor left open sleeps
+        bool focus = true;
 
         sf::Vector2i mouse(0,0);
         while (app.isOpen())
         {
-            // Slow Movement with a frame counter
-            ++frame;
-
             // Game Events
-            sf::Event event;
-            while (app.pollEvent(event))
             {
-                // Close window : exit
-                if (event.type == sf::Event::Closed)
-                    app.close();
-
-                // Scroll switching blocks
-                else if(event.type == sf::Event::MouseWheelScrolled)
+                PROFILE_SCOPE("events");
+                sf::Event event;
+
+                // With nothing held, nothing can change until an event comes in,
+                // unless there's something to animate, a save to show finishing
+                // or an autosave due. A save is checked on again after EDITOR_IDLE_TIME.
+                auto wake = CHRONO_CLOCK::time_point::max();
+                if(focus && shownAnimated) wake = nextAnimation;
+                if(saver.isBusy()) wake = std::min(wake, CHRONO_CLOCK::now() + EDITOR_IDLE_TIME);
+                if(edits && changes != autosaved) wake = std::min(wake, nextAutosave);
+
+                bool waiting = !active && !redraw;
+                while (waiting ? WaitEvent(app, event, wake) : app.pollEvent(event))
                 {
-                    if(event.mouseWheelScroll.delta > 0) --item;
-                    else ++item;
-                } 
-                
-                // Buttons which are count sensitive
-                else if(event.type == sf::Event::KeyPressed)
-                {            
-                    if(Game::upKey()) --item;
-                    else if(Game::downKey() // Save has the same key press
-                    && !sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)) 
-                        ++item;
-
-                    // Undoing
-                    if(sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)
-                    && sf::Keyboard::isKeyPressed(sf::Keyboard::Z))
+                    waiting = false;
+                    tracker.handle(event);
+
+                    // Close window : exit
+                    if (event.type == sf::Event::Closed)
+                        app.close();
+
+                    // Scroll switching blocks
+                    else if(event.type == sf::Event::MouseWheelScrolled)
                     {
-                        if(!undoList.empty())
-                        {
-                            const sf::Vector2i pos = undoList.top().pos;
-                            world[pos.x][pos.y] = undoList.top().oldBlock;
-                            undoList.pop();
+                        if(event.mouseWheelScroll.delta > 0) --item;
+                        else ++item;
+                    } 
 
-                            edits = true;
-                        }
-                    }
+                    // The window's contents may be gone
+                    else if(event.type == sf::Event::Resized
+                         || event.type == sf::Event::GainedFocus)
+                        redraw = true;
+
+                    if(event.type == sf::Event::GainedFocus) focus = true;
+                    if(event.type == sf::Event::LostFocus) focus = false;
+                }
+            }
+
+            FrameContext::Capture();
+
+            // Everything below reads the devices as of this frame
+            const Input::Snapshot input = tracker.snapshot();
+            active = Input::leftKey(input) || Input::rightKey(input)
+                  || input.down(sf::Keyboard::PageUp) || input.down(sf::Keyboard::PageDown)
+                  || input.mouse(sf::Mouse::Left) || input.mouse(sf::Mouse::Right);
+            checkSaves();
+
+            // The camera moves a block every EDITOR_CAMERA_TIME however fast frames
+            // are drawn, the first as soon as a key goes down
+            const auto now = CHRONO_CLOCK::now();
+            IntType cameraSteps = 0;
+            if(active)
+            {
+                cameraTime += now - lastFrame;
+                cameraSteps = IntType(cameraTime / EDITOR_CAMERA_TIME);
+                cameraTime -= cameraSteps * EDITOR_CAMERA_TIME;
+            } else cameraTime = EDITOR_CAMERA_TIME;
+            lastFrame = now;
+
+            // Buttons which are count sensitive, holding them repeats
+            if((input.typed(sf::Keyboard::Up) || input.typed(sf::Keyboard::W)) 
+            && !Input::cheatKey(input)) 
+                --item;
+            else if((input.typed(sf::Keyboard::Down) || input.typed(sf::Keyboard::S))
+            && !input.down(sf::Keyboard::LControl)) // Save has the same key press
+                ++item;
+
+            // Undoing
+            if(input.down(sf::Keyboard::LControl)
+            && input.typed(sf::Keyboard::Z))
+            {
+                if(!undoList.empty())
+                {
+                    const sf::Vector2i pos = undoList.top().pos;
+                    world.ref(pos.x, pos.y) = undoList.top().oldBlock;
+                    undoList.pop();
+
+                    edits = true;
+                    redraw = true;
+                    ++changes;
                 }
             }
 
             // Exiting
-            if(sf::Keyboard::isKeyPressed(sf::Keyboard::Escape) && !edits)
+            if(input.down(sf::Keyboard::Escape) && !edits)
             {  break; }
 
-            if(sf::Keyboard::isKeyPressed(sf::Keyboard::Escape) 
-            && sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
-            { break; }
+            // Throws the edits away, autosave included
+            if(input.down(sf::Keyboard::Escape) 
+            && input.down(sf::Keyboard::LControl))
+            { 
+                saver.remove(Loader::AutosavePath(level));
+                break; 
+            }
 
             // Loop Items
             item = LoopTypeIndex(item);
 
-            // Indicate Item
-            for(IntType i = 0; i < BLOCK_LIST_SIZE; ++i)
-            {
-                BlocksUp[i].setString(sortedTypeList[LoopTypeIndex(item - (i + 1))].data.name);
-                BlocksUp[i].setFillColor(sortedTypeList[LoopTypeIndex(item - (i + 1))].data.color);
-            }
-
-            Block.setString(sortedTypeList[LoopTypeIndex(item - 0)].data.name);
-            Block.setFillColor(sortedTypeList[LoopTypeIndex(item - 0)].data.color);
-            BlockDown.setString(sortedTypeList[LoopTypeIndex(item + 1)].data.name);
-            BlockDown.setFillColor(sortedTypeList[LoopTypeIndex(item + 1)].data.color);
-
             // Reverting
-            if(sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)
-            && sf::Keyboard::isKeyPressed(sf::Keyboard::LShift)
-            && sf::Keyboard::isKeyPressed(sf::Keyboard::Z)
+            if(input.down(sf::Keyboard::LControl)
+            && input.down(sf::Keyboard::LShift)
+            && input.down(sf::Keyboard::Z)
             && edits)
             {
                 edits = false;
                 undoList = std::stack<UndoData>();
-                Loader::LoadWorld(level, world); 
+                saver.remove(Loader::AutosavePath(level));
+                LoadSaved(world, level); 
+                redraw = true;
             }
 
             // Change Worlds / Moving Camera
-            if(Game::leftKey())
+            if(Input::leftKey(input))
             {
-                if(sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
+                if(input.down(sf::Keyboard::LControl))
                 {
-                    if(!edits)
+                    // Once per press, and not before the last save is on disk
+                    if(!edits && (input.pressed(sf::Keyboard::Left) || input.pressed(sf::Keyboard::A)))
+                    { 
+                        saver.flush();
+                        checkSaves();
+                    }
+
+                    if(!edits && (input.pressed(sf::Keyboard::Left) || input.pressed(sf::Keyboard::A)))
                     { 
                         cameraX = 0; 
+                        cameraY = 0; 
                         if(level != 0) --level;
                         
-                        edits = false;
-                        Loader::LoadWorld(level, world); 
-                        while(Game::leftKey());
+                        undoList = std::stack<UndoData>();
+                        edits = LoadWorld(world, level); 
+                        redraw = true;
                     }
-                } else {
-                    if(cameraX > 0 
-                    && frame % EDITOR_CAMERA_SPEED == 0) 
-                        --cameraX; 
-                }
+                } else cameraX = std::min(cameraX, std::max(cameraX - cameraSteps, 0));
             }
 
             // Change Worlds / Moving Camera
-            if(Game::rightKey())
+            if(Input::rightKey(input))
             {
-                if(sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
+                if(input.down(sf::Keyboard::LControl))
                 {
-                    if(!edits)
+                    // Once per press, and not before the last save is on disk
+                    if(!edits && (input.pressed(sf::Keyboard::Right) || input.pressed(sf::Keyboard::D)))
+                    { 
+                        saver.flush();
+                        checkSaves();
+                    }
+
+                    if(!edits && (input.pressed(sf::Keyboard::Right) || input.pressed(sf::Keyboard::D)))
                     { 
                         cameraX = 0; 
+                        cameraY = 0; 
                         if(level < MAX_LEVEL_COUNT - 1) ++level;
 
-                        edits = false;
-                        Loader::LoadWorld(level, world); 
-                        while(Game::rightKey());
+                        undoList = std::stack<UndoData>();
+                        edits = LoadWorld(world, level); 
+                        redraw = true;
                     }
-                } else {    
-                    if(cameraX < GAME_LENGTH - GAME_WIDTH 
-                    && frame % EDITOR_CAMERA_SPEED == 0) 
-                        ++cameraX; 
-                }
+                } else cameraX = std::max(cameraX, std::min(cameraX + cameraSteps, IntType(world.getLength()) - GAME_WIDTH));
             }
 
-            if(!edits)
+            // Moving Camera Vertically
+            if(input.down(sf::Keyboard::PageUp))
+                cameraY = std::min(cameraY, std::max(cameraY - cameraSteps, 0));
+
+            if(input.down(sf::Keyboard::PageDown))
+                cameraY = std::max(cameraY, std::min(cameraY + cameraSteps, IntType(world.getHeight()) - IntType(GAME_HEIGHT)));
+
+            // Saving, the autosave is out of date once it's written
+            if(edits
+            && input.down(sf::Keyboard::LControl)
+            && input.down(sf::Keyboard::S))
             {
-                if(level == 0) SavedIcon.setString("      (End Level Saved)");
-                else SavedIcon.setString("      (Level " + std::to_string(level) + " Saved)");
-                SavedIcon.setFillColor(sf::Color::Green);
-            } else {
-                if(level == 0) SavedIcon.setString("      (End Level Not Saved)");
-                else SavedIcon.setString("      (Level " + std::to_string(level) + " Not Saved)");
-                SavedIcon.setFillColor(sf::Color::Red);
-
-                // Saving 
-                if(sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)
-                && sf::Keyboard::isKeyPressed(sf::Keyboard::S))
-                {
-                    Loader::SaveWorld(level, world);
-                    edits = false;
-                }
+                saver.save(Loader::LevelPath(level), world.copy(), Loader::AutosavePath(level));
+                edits = false;
+            }
+
+            // Autosaving
+            if(edits && changes != autosaved && CHRONO_CLOCK::now() >= nextAutosave)
+            {
+                saver.save(Loader::AutosavePath(level), world.copy());
+                autosaved = changes;
+                nextAutosave = CHRONO_CLOCK::now() + EDITOR_AUTOSAVE_TIME;
             }
 
             // Calculate mouse pixel
-            mouse = sf::Mouse::getPosition(app);
+            const sf::Vector2i window = input.mousePosition;
+            mouse = window;
             mouse.x /= app.getSize().x/double(GAME_WIDTH);
             mouse.y /= app.getSize().y/double(GAME_HEIGHT);
             mouse.x += cameraX;
+            mouse.y += cameraY;
 
             // Mouse and Updating screen
-            if(sf::Mouse::getPosition(app).x >= 0 
-            && sf::Mouse::getPosition(app).x < app.getSize().x)
+            if(input.mouseInside
+            && window.x >= 0 
+            && window.x < IntType(app.getSize().x)
+            && mouse.x < IntType(world.getLength()) 
+            && mouse.y < IntType(world.getHeight()))
             {
-                if(sf::Mouse::getPosition(app).y >= 0 
-                && sf::Mouse::getPosition(app).y < app.getSize().y)
+                if(window.y >= 0 
+                && window.y < IntType(app.getSize().y))
                 {
-                    if(sf::Mouse::isButtonPressed(sf::Mouse::Left))
+                    if(input.mouse(sf::Mouse::Left))
                     {
                         // Only update if block is different
-                        if(world[mouse.x][mouse.y] != sortedTypeList[item].type)
+                        if(world.get(mouse.x, mouse.y) != sortedTypeList[item].type)
                         {
                             edits = true;
-                            undoList.push({mouse, world[mouse.x][mouse.y]});
-                            world[mouse.x][mouse.y] = sortedTypeList[item].type;
+                            undoList.push({mouse, world.get(mouse.x, mouse.y)});
+                            world.ref(mouse.x, mouse.y) = sortedTypeList[item].type;
+                            redraw = true;
+                            ++changes;
                         }
                     }
 
-                    if(sf::Mouse::isButtonPressed(sf::Mouse::Right))
-                        item = GetTypeIndex(sortedTypeList, world[mouse.x][mouse.y]);
+                    if(input.mouse(sf::Mouse::Right))
+                        item = GetTypeIndex(sortedTypeList, world.get(mouse.x, mouse.y));
+                }
+            }
+
+            const bool saving = saver.isBusy();
+
+            // Held keys keep drawing at the display's rate, otherwise
+            // wait until something moves or it's time to animate
+            if(!active && !redraw 
+            && item == shownItem && level == shownLevel && edits == shownEdits && saving == shownSaving
+            && cameraX == shownCameraX && cameraY == shownCameraY && mouse == shownMouse
+            && (!focus || !shownAnimated || CHRONO_CLOCK::now() < nextAnimation))
+                continue;
+
+            // Indicate Item
+            if(item != shownItem)
+            {
+                for(IntType i = 0; i < BLOCK_LIST_SIZE; ++i)
+                {
+                    BlocksUp[i].setString(sortedTypeList[LoopTypeIndex(item - (i + 1))].data.name);
+                    BlocksUp[i].setFillColor(sortedTypeList[LoopTypeIndex(item - (i + 1))].data.color);
+                }
+
+                Block.setString(sortedTypeList[LoopTypeIndex(item - 0)].data.name);
+                Block.setFillColor(sortedTypeList[LoopTypeIndex(item - 0)].data.color);
+                BlockDown.setString(sortedTypeList[LoopTypeIndex(item + 1)].data.name);
+                BlockDown.setFillColor(sortedTypeList[LoopTypeIndex(item + 1)].data.color);
+            }
+
+            if(level != shownLevel || edits != shownEdits || saving != shownSaving)
+            {
+                if(edits)
+                {
+                    if(level == 0) SavedIcon.setString("      (End Level Not Saved)");
+                    else SavedIcon.setString("      (Level " + std::to_string(level) + " Not Saved)");
+                    SavedIcon.setFillColor(sf::Color::Red);
+                } else if(saving) {
+                    if(level == 0) SavedIcon.setString("      (End Level Saving)");
+                    else SavedIcon.setString("      (Level " + std::to_string(level) + " Saving)");
+                    SavedIcon.setFillColor(sf::Color::Yellow);
+                } else {
+                    if(level == 0) SavedIcon.setString("      (End Level Saved)");
+                    else SavedIcon.setString("      (Level " + std::to_string(level) + " Saved)");
+                    SavedIcon.setFillColor(sf::Color::Green);
                 }
             }
 
+            // Update Title
+            if(level != shownLevel)
+            {
+                if(level == 0) app.setTitle("Upside Down Level Editor (End Level)");
+                else app.setTitle("Upside Down Level Editor (Level " + std::to_string(level) + ")");
+            }
+
+            shownItem = item;
+            shownLevel = level;
+            shownEdits = edits;
+            shownSaving = saving;
+            shownCameraX = cameraX;
+            shownCameraY = cameraY;
+            shownMouse = mouse;
+            redraw = false;
+            nextAnimation = CHRONO_CLOCK::now() + EDITOR_ANIMATION_TIME;
+
             // Draw World
-            updateBuffer(buffer, world, cameraX, sortedTypeList[item].type, mouse);
-            Graphics::pushRGBA(app, reinterpret_cast<const Byte*>(buffer));
+            shownAnimated = updateBuffer(buffer, world, cameraX, cameraY, sortedTypeList[item].type, mouse);
+            renderer.pushRGBA(app, reinterpret_cast<const Byte*>(buffer));
 
             // Draw Text
             app.draw(SavedIcon);
@@ -307,16 +524,19 @@ namespace LevelBuilder
             app.draw(Block);
             app.draw(BlockDown);
 
-            // Update Title
-            if(level == 0) app.setTitle("Upside Down Level Editor (End Level)");
-            else app.setTitle("Upside Down Level Editor (Level " + std::to_string(level) + ")");
-
             // Show To User
-            app.display();
+            {
+                PROFILE_SCOPE("display");
+                renderer.display(app);
+            }
+            PROFILE_FRAME();
         }
 
+        // Closing the window doesn't lose anything, the
+        // edits are there the next time the level is opened
+        if(!app.isOpen() && edits) saver.save(Loader::AutosavePath(level), world.copy());
+
         app.setTitle("Upside Down");
-        app.setFramerateLimit(GAME_FPS);
         return level;
     }
 }
@@ -0,0 +1,192 @@
+#ifndef LEVEL_CACHE_H
+#define LEVEL_CACHE_H
+
+#include "./Constants.h"
+#include "./FileLoader.h"
+#include "./World.h"
+
+#include <condition_variable> // Waking the worker
+#include <vector> // Cached chunks
+#include <deque> // Prefetch queue
+#include <memory> // World buffers
+#include <mutex> // Guarding slots
+#include <thread> // Prefetch worker
+
+// The first chunks of each level kept in memory, so going through a goal
+// is a copy instead of a file read. The next level is read on a worker
+// thread while the current one is being played, anything past what's
+// kept here is paged in by the World as the camera reaches it.
+class LevelCache
+{
+public:
+    // Enough for a whole level of the default size
+    static constexpr std::size_t LEVEL_BYTES = 1 << 16;
+
+    LevelCache() {}
+    LevelCache(const LevelCache&) = delete;
+    LevelCache& operator=(const LevelCache&) = delete;
+
+    ~LevelCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if(worker.joinable()) worker.join();
+    }
+
+    // Starts out on a level, reading it now if it hasn't been read yet,
+    // returns false if there is no such level
+    bool load(IntType lvl, World& out)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        Slot& slot = slots[lvl];
+
+        // Already on its way, just wait for it
+        while(slot.pending) ready.wait(lock);
+
+        if(!slot.loaded)
+        {
+            lock.unlock();
+            Level level = Read(lvl);
+            lock.lock();
+
+            store(slot, std::move(level));
+        }
+
+        const Level& level = slot.level;
+        if(!level.exists) return false;
+
+        out.open(lvl, level.length, level.height);
+        for(RawIntType i = 0; i < level.chunks.size(); ++i)
+            out.adopt(i, level.chunks[i].get());
+        return true;
+    }
+
+    // Starts reading a level in the background if it isn't already
+    void prefetch(IntType lvl)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Slot& slot = slots[lvl];
+            if(slot.loaded || slot.pending) return;
+
+            slot.pending = true;
+            queue.push_back({lvl, generation});
+
+            if(!worker.joinable()) worker = std::thread(&LevelCache::workerLoop, this);
+        }
+        wake.notify_one();
+    }
+
+    // Forgets everything, for when level files change on disk
+    void clear()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++generation;
+
+            // Anything already being read is read again by the worker
+            for(const Job& job : queue) slots[job.lvl].pending = false;
+            queue.clear();
+
+            for(Slot& slot : slots)
+            {
+                slot.loaded = false;
+                slot.level = Level();
+            }
+        }
+        ready.notify_all();
+    }
+
+private:
+    struct Level
+    {
+        bool exists = false;
+        RawIntType length = 0, height = 0;
+        std::vector<World::Cells> chunks;
+    };
+
+    struct Slot
+    {
+        bool loaded = false, pending = false;
+        Level level;
+    };
+
+    struct Job
+    {
+        IntType lvl;
+        RawIntType generation;
+    };
+
+    // The header and as many chunks from the start as LEVEL_BYTES allows
+    static Level Read(IntType lvl)
+    {
+        Level level;
+        Loader::LevelFile file;
+        if(!file.open(lvl)) return level;
+
+        level.exists = true;
+        level.length = file.getLength();
+        level.height = file.getHeight();
+
+        const std::size_t chunkSize = std::size_t(CHUNK_WIDTH) * level.height;
+        const std::size_t count = std::min<std::size_t>(file.getChunkCount(), std::max<std::size_t>(1, LEVEL_BYTES / chunkSize));
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            level.chunks.emplace_back(new GameType[chunkSize]);
+            file.readChunk(i, level.chunks.back().get());
+        }
+
+        return level;
+    }
+
+    void store(Slot& slot, Level level)
+    {
+        slot.loaded = true;
+        slot.level = std::move(level);
+    }
+
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(true)
+        {
+            while(!stopping && queue.empty()) wake.wait(lock);
+            if(stopping) return;
+
+            const Job job = queue.front();
+            queue.pop_front();
+
+            // Read without holding the lock so the game never waits on the disk
+            lock.unlock();
+            Level level = Read(job.lvl);
+            lock.lock();
+
+            // Files changed while this was being read, it's out of date.
+            // The slot stays pending so nobody reads it on the game thread meanwhile
+            if(job.generation != generation)
+            {
+                queue.push_front({job.lvl, generation});
+                continue;
+            }
+
+            Slot& slot = slots[job.lvl];
+            store(slot, std::move(level));
+            slot.pending = false;
+            ready.notify_all();
+        }
+    }
+
+    Slot slots[MAX_LEVEL_COUNT];
+    std::deque<Job> queue;
+    RawIntType generation = 0;
+    bool stopping = false;
+
+    std::mutex mutex;
+    std::condition_variable wake, ready;
+    std::thread worker;
+};
+
+#endif // LEVEL_CACHE_H
@@ -0,0 +1,202 @@
+#ifndef LEVEL_INDEX_H
+#define LEVEL_INDEX_H
+
+#include "./Constants.h"
+#include "./NumberLookup.h"
+#include "./FileLoader.h"
+
+#include <atomic> // Handing out levels to threads
+#include <filesystem> // File size and time
+#include <thread> // Hashing levels in parallel
+#include <vector> // Levels to hash
+
+// What the game needs to know about every level file without reading
+// them all again. A level is only opened and hashed again when its file
+// size or modified time changes, and those are hashed in parallel.
+//
+// Each level is hashed on its own starting from 0, then the level hashes
+// are mixed together in order, so editing any level still changes the total.
+class LevelIndex
+{
+public:
+    // Checks every level file's size and time, rehashes the ones that changed,
+    // returns true if anything did
+    bool refresh()
+    {
+        std::vector<IntType> stale;
+        for(IntType lvl = 0; lvl < MAX_LEVEL_COUNT; ++lvl)
+        {
+            Entry& entry = entries[lvl];
+            const FileStamp stamp = Stamp(lvl);
+            if(entry.known && stamp == entry.stamp) continue;
+
+            entry.stamp = stamp;
+            entry.known = true;
+            stale.push_back(lvl);
+        }
+
+        if(stale.empty()) return false;
+
+        // Split the levels up between as many threads as will help
+        const std::size_t threads = std::min<std::size_t>(
+            stale.size(), std::max(1u, std::thread::hardware_concurrency()));
+        std::atomic<std::size_t> next(0);
+
+        std::vector<std::thread> pool;
+        for(std::size_t i = 1; i < threads; ++i)
+            pool.emplace_back(&LevelIndex::hashWorker, this, std::cref(stale), std::ref(next));
+        hashWorker(stale, next);
+        for(std::thread& thread : pool) thread.join();
+
+        combine();
+        return true;
+    }
+
+    bool isValid() const { return valid; }
+    HashType getHash() const { return hash; }
+    IntType getFinalLevel() const { return finalLevel; }
+    IntType getTotalCoins() const { return totalCoins; }
+
+    bool exists(IntType lvl) const { return entries[Clamp(lvl)].exists; }
+    IntType getCoins(IntType lvl) const { return entries[Clamp(lvl)].coins; }
+
+    // First level at or after lvl that exists, wrapping around,
+    // or -1 if there are no levels at all
+    IntType findLevel(IntType lvl) const
+    {
+        for(IntType i = 0; i < MAX_LEVEL_COUNT; ++i)
+        {
+            const IntType next = (lvl + i) % MAX_LEVEL_COUNT;
+            if(entries[next].exists) return next;
+        }
+        return -1;
+    }
+
+private:
+    static constexpr HashType Rotate(HashType x, IntType rot)
+    {
+        return (x << rot) | (x >> (sizeof(x)*8 - rot));
+    }
+
+    // One round of the level hash
+    static constexpr HashType Mix(HashType hash, IntType lvl, HashType value)
+    {
+        hash += Rotate(hash, 7);
+        hash += Rotate(hash, 20 + (19*lvl)%23);
+        hash += value;
+        hash += Rotate(hash, 43);
+        return hash;
+    }
+
+    static IntType Clamp(IntType lvl)
+    {
+        return std::max(IntType(0), std::min(lvl, MAX_LEVEL_COUNT - 1));
+    }
+
+    /***********************/
+    /***** FILE STAMPS *****/
+    /***********************/
+
+    struct FileStamp
+    {
+        bool found = false;
+        std::uintmax_t size = 0;
+        std::filesystem::file_time_type time{};
+
+        bool operator==(const FileStamp& other) const
+        {
+            return found == other.found && size == other.size && time == other.time;
+        }
+    };
+
+    static FileStamp Stamp(IntType lvl)
+    {
+        const std::filesystem::path path(LEVEL_FOLDER + LEVEL_PREFIX + std::to_string(lvl) + LEVEL_EXTENTION);
+
+        FileStamp stamp;
+        std::error_code error;
+        stamp.size = std::filesystem::file_size(path, error);
+        if(error) return FileStamp();
+
+        stamp.time = std::filesystem::last_write_time(path, error);
+        if(error) return FileStamp();
+
+        stamp.found = true;
+        return stamp;
+    }
+
+    /*******************/
+    /***** HASHING *****/
+    /*******************/
+
+    struct Entry
+    {
+        bool known = false, exists = false;
+        FileStamp stamp;
+        HashType hash = 0;
+        IntType coins = 0;
+    };
+
+    void hashWorker(const std::vector<IntType>& stale, std::atomic<std::size_t>& next)
+    {
+        Loader::LevelFile file;
+        for(std::size_t i = next++; i < stale.size(); i = next++)
+            hashLevel(stale[i], file);
+    }
+
+    // Each thread only ever touches its own levels' entries. A level is
+    // hashed from its size and checksum, which version 2 files store in
+    // their header, so only version 1 files are read all the way through.
+    void hashLevel(IntType lvl, Loader::LevelFile& file)
+    {
+        Entry& entry = entries[lvl];
+        entry.hash = 0;
+        entry.coins = 0;
+        entry.exists = entry.stamp.found && file.open(lvl);
+
+        if(entry.exists)
+        {
+            RawIntType checksum = 0, coins = 0;
+            file.summarize(checksum, coins);
+            entry.coins = coins;
+
+            entry.hash = Mix(entry.hash, lvl, file.getLength());
+            entry.hash = Mix(entry.hash, lvl, file.getHeight());
+            entry.hash = Mix(entry.hash, lvl, checksum);
+            entry.hash = Mix(entry.hash, lvl, coins);
+            file.close();
+        } else
+        {
+            for(IntType round = 0; round < 0x100; ++round)
+                entry.hash = Mix(entry.hash, lvl, LookUp::PiTable[Byte(round)]);
+        }
+    }
+
+    void combine()
+    {
+        hash = 0;
+        finalLevel = 0;
+        totalCoins = 0;
+        for(IntType lvl = 0; lvl < MAX_LEVEL_COUNT; ++lvl)
+        {
+            const Entry& entry = entries[lvl];
+            if(entry.exists) finalLevel = lvl;
+            totalCoins += entry.coins;
+            hash = Mix(hash, lvl, entry.hash);
+        }
+
+        // Final Mix
+        for(IntType round = 0; round < 0x100; ++round)
+            hash = Mix(hash, round, LookUp::PiTable[Byte(round)]);
+
+        valid = true;
+    }
+
+    Entry entries[MAX_LEVEL_COUNT];
+
+    bool valid = false;
+    HashType hash = 0;
+    IntType finalLevel = 0, totalCoins = 0;
+};
+
+#endif // LEVEL_INDEX_H
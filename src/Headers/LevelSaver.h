@@ -0,0 +1,119 @@
+#ifndef LEVEL_SAVER_H
+#define LEVEL_SAVER_H
+
+#include "./Constants.h"
+#include "./FileLoader.h"
+
+#include <atomic> // Failed writes
+#include <condition_variable> // Waking the writer
+#include <filesystem> // Removing autosaves
+#include <map> // Pending work by file
+#include <mutex> // Shared with the writer
+#include <thread> // Writer thread
+
+// Writes levels on its own thread so the editor never waits on the disk.
+// Each file only keeps the newest thing asked of it, so saving the same
+// level again before the last one was written only writes once.
+class LevelSaver
+{
+public:
+    LevelSaver() : thread(&LevelSaver::run, this) {}
+
+    // Anything still waiting is written first
+    ~LevelSaver()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+
+    LevelSaver(const LevelSaver&) = delete;
+    LevelSaver& operator=(const LevelSaver&) = delete;
+
+    // replaces is a file this save makes out of date, like the level's
+    // autosave. Writes to it still waiting are dropped, and it's removed
+    // once this save is on disk.
+    void save(const std::string& path, Loader::LevelData level, const std::string& replaces = std::string())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!replaces.empty()) pending.erase(replaces);
+        }
+        push(path, {false, std::move(level), replaces});
+    }
+
+    void remove(const std::string& path)
+    {
+        push(path, {true, Loader::LevelData(), std::string()});
+    }
+
+    // Waits until everything asked for so far is on disk
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending.empty() && !writing; });
+    }
+
+    bool isBusy() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !pending.empty() || writing;
+    }
+
+    std::uintmax_t getFailures() const { return failures; }
+
+private:
+    struct Job
+    {
+        bool remove;
+        Loader::LevelData level;
+        std::string replaces;
+    };
+
+    void push(const std::string& path, Job job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending[path] = std::move(job);
+        }
+        wake.notify_all();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(true)
+        {
+            wake.wait(lock, [this] { return stopping || !pending.empty(); });
+            if(pending.empty()) return;
+
+            const std::string path = pending.begin()->first;
+            const Job job = std::move(pending.begin()->second);
+            pending.erase(pending.begin());
+            writing = true;
+
+            // Nothing else waits on the disk
+            lock.unlock();
+            std::error_code error;
+            if(job.remove) std::filesystem::remove(path, error);
+            else if(!Loader::SaveLevel(path, job.level)) ++failures;
+            else if(!job.replaces.empty()) std::filesystem::remove(job.replaces, error);
+            lock.lock();
+
+            writing = false;
+            done.notify_all();
+        }
+    }
+
+    mutable std::mutex mutex;
+    std::condition_variable wake, done;
+    std::map<std::string, Job> pending;
+    bool writing = false, stopping = false;
+    std::atomic<std::uintmax_t> failures{0};
+    std::thread thread; // Started last, after everything it uses
+};
+
+#endif // LEVEL_SAVER_H
@@ -0,0 +1,59 @@
+#ifndef NOISE_H
+#define NOISE_H
+
+#include "Constants.h"
+
+#include <array> // Randomness of each type
+
+// Block textures come from RANDOMIZE(XRand * YRand) % randomness, where
+// XRand = 1 + x + the type's texture phase and YRand = 1 + y. RANDOMIZE is 13
+// rounds of multiplies and modulos, far too much to run for every pixel, so
+// each type's texture is worked out once for a tile of XRand and y and read
+// back from there.
+//
+// Inside the tile (0 <= XRand < TILE_X, 0 <= y < TILE_Y) the table holds the
+// exact same values, past it the tile repeats, which looks the same on screen.
+namespace Noise
+{
+    class Field
+    {
+    public:
+        static constexpr IntType TILE_X = 128; // Power of 2
+        static constexpr IntType TILE_Y = 32; // Power of 2, at least GAME_HEIGHT
+
+        using TypeRandomness = std::array<IntType, GameTypeCount>;
+
+        explicit Field(const TypeRandomness& randomness)
+        {
+            for(IntType type = 0; type < GameTypeCount; ++type)
+                for(IntType y = 0; y < TILE_Y; ++y)
+                    for(IntType x = 0; x < TILE_X; ++x)
+                        table[type][y][x] = randomness[type] == 0
+                            ? Byte(0) : Byte(Exact(randomness[type], x, 1 + y));
+        }
+
+        // What every texture used to do per pixel
+        static IntType Exact(IntType randomness, IntType XRand, IntType YRand)
+        {
+            return std::abs(RANDOMIZE(XRand * YRand)) % randomness;
+        }
+
+        IntType sample(IntType type, IntType XRand, IntType y) const
+        {
+            return table[type][y & (TILE_Y - 1)][XRand & (TILE_X - 1)];
+        }
+
+        // Turn on to run RANDOMIZE for every pixel again, so frames
+        // match older builds byte for byte
+        static void SetExact(bool value) { exact = value; }
+        static bool IsExact() { return exact; }
+
+    private:
+        static inline bool exact = false;
+
+        // Randomness is never more than 255 either way
+        Byte table[GameTypeCount][TILE_Y][TILE_X];
+    };
+}
+
+#endif // NOISE_H
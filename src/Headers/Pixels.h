@@ -0,0 +1,340 @@
+#ifndef PIXELS_H
+#define PIXELS_H
+
+#include "Constants.h"
+
+#include <cstring> // Copying rows
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define PIXELS_X86
+    #include <immintrin.h>
+#endif
+
+// Colour stages that run on a whole row of the screen at once, once each pixel's
+// base colour (block color, texture and smog) is known.
+//
+// Every stage is done with integer maths that gives exactly what the old per
+// pixel double maths gave, so all versions match byte for byte:
+//   Start Area: G + 48
+//   Trap Wall:  n = 32*(trapX - 5*column), R + n/5, G - n/20, B - n/20 (for n >= 0)
+//   Lost Focus: (2*v + 256)/3
+//   Cap:        0 to 255
+// Divisions round towards zero like the double to int conversions did.
+namespace Pixels
+{
+    // Rows are padded so the vector versions never need a scalar tail
+    static constexpr IntType ROW_PAD = (GAME_WIDTH + 7) / 8 * 8;
+
+    static constexpr IntType START_TINT = 48;
+    static constexpr IntType TRAP_STEP = IntType(TRAP_SPEED);
+    static constexpr IntType TRAP_RED = IntType(256.0/TRAP_SMOOTH);
+    static_assert(TRAP_STEP == TRAP_SPEED && TRAP_RED == 256.0/TRAP_SMOOTH,
+                  "Trap gradient has to be whole numbers to be exact");
+
+    static constexpr IntType FOCUS_SCALE = 2;
+    static constexpr IntType FOCUS_ADD = 256;
+    static constexpr IntType FOCUS_DIV = 3;
+    static_assert(LOST_FOCUS_COLOR == 1.5, "Lost focus blend is hard coded to 1.5");
+
+    // Base colour of one row, before any of the stages
+    struct Row
+    {
+        alignas(32) IntType r[ROW_PAD] = {};
+        alignas(32) IntType g[ROW_PAD] = {};
+        alignas(32) IntType b[ROW_PAD] = {};
+    };
+
+    // Everything the stages need to know about the frame
+    struct Shade
+    {
+        IntType startColumns; // Columns before this get the start area tint
+        IntType trapRed; // n for column 0, drops by TRAP_RED*TRAP_STEP each column
+        bool focus;
+
+        static Shade Make(IntType cameraX, IntType trapX, bool focus)
+        {
+            return {START_SIZE - cameraX + 1, TRAP_RED*(trapX - TRAP_STEP*cameraX), focus};
+        }
+
+        // No trap wall, used by the level editor
+        static Shade Make(IntType cameraX)
+        {
+            return {START_SIZE - cameraX + 1, -TRAP_RED*TRAP_STEP*ROW_PAD, true};
+        }
+    };
+
+    /******************/
+    /***** SCALAR *****/
+    /******************/
+
+    static void ShadeRowScalar(const Row& row, const Shade& shade, Byte* out)
+    {
+        for(IntType x = 0; x < GAME_WIDTH; ++x)
+        {
+            IntType R = row.r[x], G = row.g[x], B = row.b[x];
+
+            // Start Area
+            if(x < shade.startColumns) G += START_TINT;
+
+            // Trap Wall
+            const IntType n = shade.trapRed - TRAP_RED*TRAP_STEP*x;
+            if(n >= 0)
+            {
+                R = (TRAP_STEP*R + n) / TRAP_STEP;
+                G = (4*TRAP_STEP*G - n) / (4*TRAP_STEP);
+                B = (4*TRAP_STEP*B - n) / (4*TRAP_STEP);
+            }
+
+            if(!shade.focus)
+            {
+                R = (FOCUS_SCALE*R + FOCUS_ADD) / FOCUS_DIV;
+                G = (FOCUS_SCALE*G + FOCUS_ADD) / FOCUS_DIV;
+                B = (FOCUS_SCALE*B + FOCUS_ADD) / FOCUS_DIV;
+            }
+
+            // Cap RGB Values
+            out[4*x + 0] = static_cast<Byte>(std::max(std::min(R, IntType(255)), IntType(0))); // Red
+            out[4*x + 1] = static_cast<Byte>(std::max(std::min(G, IntType(255)), IntType(0))); // Green
+            out[4*x + 2] = static_cast<Byte>(std::max(std::min(B, IntType(255)), IntType(0))); // Blue
+            out[4*x + 3] = 255; // Alpha
+        }
+    }
+
+#ifdef PIXELS_X86
+    /****************/
+    /***** SSE2 *****/
+    /****************/
+
+    // Division that rounds towards zero, exact for the small numbers used here
+    __attribute__((target("sse2")))
+    static inline __m128i DivideSSE2(__m128i num, float den)
+    {
+        return _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(num), _mm_set1_ps(den)));
+    }
+
+    // SSE2 has no 32bit multiply, so multiply the even and odd lanes separately
+    __attribute__((target("sse2")))
+    static inline __m128i MultiplySSE2(__m128i num, IntType by)
+    {
+        const __m128i mul = _mm_set1_epi32(by);
+        const __m128i even = _mm_mul_epu32(num, mul);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(num, 32), mul);
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    // 4 pixels of planar 32bit colour into 16 bytes of RGBA, saturating to 0 - 255
+    __attribute__((target("sse2")))
+    static inline void StoreRGBASSE2(Byte* out, __m128i R, __m128i G, __m128i B)
+    {
+        const __m128i A = _mm_set1_epi32(255);
+        const __m128i RB0 = _mm_unpacklo_epi32(R, B), RB1 = _mm_unpackhi_epi32(R, B);
+        const __m128i GA0 = _mm_unpacklo_epi32(G, A), GA1 = _mm_unpackhi_epi32(G, A);
+        const __m128i P01 = _mm_packs_epi32(_mm_unpacklo_epi32(RB0, GA0), _mm_unpackhi_epi32(RB0, GA0));
+        const __m128i P23 = _mm_packs_epi32(_mm_unpacklo_epi32(RB1, GA1), _mm_unpackhi_epi32(RB1, GA1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(P01, P23));
+    }
+
+    __attribute__((target("sse2")))
+    static void ShadeRowSSE2(const Row& row, const Shade& shade, Byte* out)
+    {
+        alignas(16) Byte padded[ROW_PAD*4];
+        const __m128i lane = _mm_set_epi32(3, 2, 1, 0);
+
+        for(IntType x = 0; x < ROW_PAD; x += 4)
+        {
+            __m128i R = _mm_load_si128(reinterpret_cast<const __m128i*>(&row.r[x]));
+            __m128i G = _mm_load_si128(reinterpret_cast<const __m128i*>(&row.g[x]));
+            __m128i B = _mm_load_si128(reinterpret_cast<const __m128i*>(&row.b[x]));
+            const __m128i column = _mm_add_epi32(_mm_set1_epi32(x), lane);
+
+            // Start Area
+            const __m128i start = _mm_cmpgt_epi32(_mm_set1_epi32(shade.startColumns), column);
+            G = _mm_add_epi32(G, _mm_and_si128(start, _mm_set1_epi32(START_TINT)));
+
+            // Trap Wall
+            const __m128i n = _mm_sub_epi32(_mm_set1_epi32(shade.trapRed), 
+                MultiplySSE2(column, TRAP_RED*TRAP_STEP));
+            const __m128i trap = _mm_cmpgt_epi32(n, _mm_set1_epi32(-1));
+            const __m128i R5 = _mm_add_epi32(MultiplySSE2(R, TRAP_STEP), n);
+            const __m128i G20 = _mm_sub_epi32(MultiplySSE2(G, 4*TRAP_STEP), n);
+            const __m128i B20 = _mm_sub_epi32(MultiplySSE2(B, 4*TRAP_STEP), n);
+            R = _mm_or_si128(_mm_and_si128(trap, DivideSSE2(R5, TRAP_STEP)), _mm_andnot_si128(trap, R));
+            G = _mm_or_si128(_mm_and_si128(trap, DivideSSE2(G20, 4*TRAP_STEP)), _mm_andnot_si128(trap, G));
+            B = _mm_or_si128(_mm_and_si128(trap, DivideSSE2(B20, 4*TRAP_STEP)), _mm_andnot_si128(trap, B));
+
+            if(!shade.focus)
+            {
+                const __m128i add = _mm_set1_epi32(FOCUS_ADD);
+                R = DivideSSE2(_mm_add_epi32(_mm_add_epi32(R, R), add), FOCUS_DIV);
+                G = DivideSSE2(_mm_add_epi32(_mm_add_epi32(G, G), add), FOCUS_DIV);
+                B = DivideSSE2(_mm_add_epi32(_mm_add_epi32(B, B), add), FOCUS_DIV);
+            }
+
+            StoreRGBASSE2(&padded[4*x], R, G, B);
+        }
+
+        std::memcpy(out, padded, GAME_WIDTH*4);
+    }
+
+    /****************/
+    /***** AVX2 *****/
+    /****************/
+
+    __attribute__((target("avx2")))
+    static inline __m256i DivideAVX2(__m256i num, float den)
+    {
+        return _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(num), _mm256_set1_ps(den)));
+    }
+
+    __attribute__((target("avx2")))
+    static void ShadeRowAVX2(const Row& row, const Shade& shade, Byte* out)
+    {
+        alignas(32) Byte padded[ROW_PAD*4];
+        const __m256i lane = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+        for(IntType x = 0; x < ROW_PAD; x += 8)
+        {
+            __m256i R = _mm256_load_si256(reinterpret_cast<const __m256i*>(&row.r[x]));
+            __m256i G = _mm256_load_si256(reinterpret_cast<const __m256i*>(&row.g[x]));
+            __m256i B = _mm256_load_si256(reinterpret_cast<const __m256i*>(&row.b[x]));
+            const __m256i column = _mm256_add_epi32(_mm256_set1_epi32(x), lane);
+
+            // Start Area
+            const __m256i start = _mm256_cmpgt_epi32(_mm256_set1_epi32(shade.startColumns), column);
+            G = _mm256_add_epi32(G, _mm256_and_si256(start, _mm256_set1_epi32(START_TINT)));
+
+            // Trap Wall
+            const __m256i n = _mm256_sub_epi32(_mm256_set1_epi32(shade.trapRed),
+                _mm256_mullo_epi32(column, _mm256_set1_epi32(TRAP_RED*TRAP_STEP)));
+            const __m256i trap = _mm256_cmpgt_epi32(n, _mm256_set1_epi32(-1));
+            const __m256i R5 = _mm256_add_epi32(_mm256_mullo_epi32(R, _mm256_set1_epi32(TRAP_STEP)), n);
+            const __m256i G20 = _mm256_sub_epi32(_mm256_mullo_epi32(G, _mm256_set1_epi32(4*TRAP_STEP)), n);
+            const __m256i B20 = _mm256_sub_epi32(_mm256_mullo_epi32(B, _mm256_set1_epi32(4*TRAP_STEP)), n);
+            R = _mm256_blendv_epi8(R, DivideAVX2(R5, TRAP_STEP), trap);
+            G = _mm256_blendv_epi8(G, DivideAVX2(G20, 4*TRAP_STEP), trap);
+            B = _mm256_blendv_epi8(B, DivideAVX2(B20, 4*TRAP_STEP), trap);
+
+            if(!shade.focus)
+            {
+                const __m256i add = _mm256_set1_epi32(FOCUS_ADD);
+                R = DivideAVX2(_mm256_add_epi32(_mm256_add_epi32(R, R), add), FOCUS_DIV);
+                G = DivideAVX2(_mm256_add_epi32(_mm256_add_epi32(G, G), add), FOCUS_DIV);
+                B = DivideAVX2(_mm256_add_epi32(_mm256_add_epi32(B, B), add), FOCUS_DIV);
+            }
+
+            // Interleave each half the same way as SSE2
+            StoreRGBASSE2(&padded[4*x], _mm256_castsi256_si128(R),
+                _mm256_castsi256_si128(G), _mm256_castsi256_si128(B));
+            StoreRGBASSE2(&padded[4*x + 16], _mm256_extracti128_si256(R, 1),
+                _mm256_extracti128_si256(G, 1), _mm256_extracti128_si256(B, 1));
+        }
+
+        std::memcpy(out, padded, GAME_WIDTH*4);
+    }
+#endif // PIXELS_X86
+
+    /****************/
+    /***** SMOG *****/
+    /****************/
+
+    // Smog falloff only depends on how far a pixel is from the player, so it's worked
+    // out once for every offset that fits on screen. Multiplying by 2^32/distance^2
+    // (rounded up) gives the same answer as dividing did for any colour below 2048.
+    //
+    // The dither is a tile of the old per pixel noise that jumps somewhere new every
+    // frame, so it looks the same without running RANDOMIZE for every pixel.
+    class SmogKernel
+    {
+    public:
+        static constexpr IntType REACH_X = GAME_WIDTH;
+        static constexpr IntType REACH_Y = GAME_HEIGHT;
+        static constexpr IntType DITHER_SIZE = 64; // Power of 2
+        static constexpr IntType SCALE_SHIFT = 32;
+
+        static const SmogKernel& Get()
+        {
+            static const SmogKernel kernel;
+            return kernel;
+        }
+
+        // Where the dither tile sits this frame
+        static IntType DitherOffset(IntType frame)
+        {
+            return RANDOMIZE(frame);
+        }
+
+        IntType attenuate(IntType color, IntType dx, IntType dy) const
+        {
+            if(std::abs(dx) > REACH_X || std::abs(dy) > REACH_Y)
+            {
+                // Off the edge of the kernel, do it the slow way
+                const double dis = Distance(dx, dy);
+                return IntType(color / (dis*dis));
+            }
+
+            // Textures can push a color below zero, round those toward zero too
+            const std::uint64_t size = std::uint64_t(std::abs(color));
+            const IntType out = IntType((size * scale[dy + REACH_Y][dx + REACH_X]) >> SCALE_SHIFT);
+            return color < 0 ? -out : out;
+        }
+
+        IntType dither(IntType worldX, IntType y, IntType offset) const
+        {
+            const IntType offsetX = offset & (DITHER_SIZE - 1), offsetY = (offset >> 6) & (DITHER_SIZE - 1);
+            return noise[(y + offsetY) & (DITHER_SIZE - 1)][(worldX + offsetX) & (DITHER_SIZE - 1)];
+        }
+
+    private:
+        static double Distance(IntType dx, IntType dy)
+        {
+            return std::max(1.0, std::hypot(double(dx), double(dy)) - SMOG_SIZE);
+        }
+
+        SmogKernel()
+        {
+            for(IntType dy = -REACH_Y; dy <= REACH_Y; ++dy)
+            {
+                for(IntType dx = -REACH_X; dx <= REACH_X; ++dx)
+                {
+                    const double dis = Distance(dx, dy);
+                    scale[dy + REACH_Y][dx + REACH_X] = 
+                        std::uint64_t(double(std::uint64_t(1) << SCALE_SHIFT) / (dis*dis)) + 1;
+                }
+            }
+
+            for(IntType y = 0; y < DITHER_SIZE; ++y)
+                for(IntType x = 0; x < DITHER_SIZE; ++x)
+                    noise[y][x] = std::int8_t(RANDOMIZE((x + 1)*(y + 1))%4);
+        }
+
+        std::uint64_t scale[2*REACH_Y + 1][2*REACH_X + 1];
+        std::int8_t noise[DITHER_SIZE][DITHER_SIZE]; // Same -3 to 3 spread as RANDOMIZE()%4
+    };
+
+    /*******************/
+    /***** DISPATCH ****/
+    /*******************/
+
+    using ShadeRowFunction = void (*)(const Row&, const Shade&, Byte*);
+
+    // Best version this CPU can run, picked the first time it's needed
+    static ShadeRowFunction PickShadeRow()
+    {
+    #ifdef PIXELS_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) return ShadeRowAVX2;
+        if(__builtin_cpu_supports("sse2")) return ShadeRowSSE2;
+    #endif
+        return ShadeRowScalar;
+    }
+
+    // out has to fit GAME_WIDTH RGBA pixels
+    inline void ShadeRow(const Row& row, const Shade& shade, Byte* out)
+    {
+        static const ShadeRowFunction shadeRow = PickShadeRow();
+        shadeRow(row, shade, out);
+    }
+}
+
+#endif // PIXELS_H
@@ -0,0 +1,225 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Constants.h"
+
+#include <algorithm> // Sorting stages
+#include <atomic> // Numbering threads
+#include <mutex> // Tools run games on several threads
+#include <ostream> // Reports and traces
+#include <string> // Stage names
+#include <unordered_map> // Stages by name
+#include <vector> // Trace events
+
+// Times named stages of the game loop and drawing. Built with
+// -DPROFILER_ENABLED, PROFILE_SCOPE and PROFILE_FRAME compile to nothing
+// otherwise, so normal and headless builds pay nothing for them.
+//
+// Each stage keeps its totals, and every timed scope goes into a trace
+// that chrome://tracing and Perfetto can open, up to PROFILER_MAX_EVENTS.
+// Frame times go into a histogram of PROFILER_BUCKET_MS wide buckets.
+namespace Profiler
+{
+#ifdef PROFILER_ENABLED
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    static constexpr std::size_t PROFILER_MAX_EVENTS = 1 << 20;
+    static constexpr double PROFILER_BUCKET_MS = 1;
+    static constexpr IntType PROFILER_BUCKETS = 100; // The last one is everything longer
+    static constexpr double PROFILER_DECAY = 0.95; // How fast the slowest stages are forgotten
+
+    struct Stage
+    {
+        std::string name;
+        std::uintmax_t count = 0;
+        double total = 0, worst = 0; // Milliseconds
+        double frame = 0; // Time in the frame so far
+        double recent = 0; // Slowest frame lately, fading each frame
+    };
+
+    class Recorder
+    {
+    public:
+        using TimePoint = CHRONO_CLOCK::time_point;
+
+        static Recorder& Get()
+        {
+            static Recorder recorder;
+            return recorder;
+        }
+
+        // Stages are told apart by name, the same literal can have a different
+        // address in each file. Names have to outlive the trace.
+        void record(const char* name, TimePoint start, TimePoint end)
+        {
+            const double milliseconds = Milliseconds(end - start);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            Stage& stage = stages[name];
+            if(stage.count == 0) stage.name = name;
+            ++stage.count;
+            stage.total += milliseconds;
+            stage.worst = std::max(stage.worst, milliseconds);
+            stage.frame += milliseconds;
+
+            if(events.size() < PROFILER_MAX_EVENTS)
+                events.push_back({name, start, end, ThreadIndex()});
+        }
+
+        // Ends a frame, from the last call to this one
+        void frame()
+        {
+            const TimePoint now = CHRONO_CLOCK::now();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if(frames != 0)
+            {
+                const double milliseconds = Milliseconds(now - lastFrame);
+                const IntType bucket = IntType(milliseconds / PROFILER_BUCKET_MS);
+                ++histogram[std::min(bucket, PROFILER_BUCKETS - 1)];
+            }
+            lastFrame = now;
+            ++frames;
+
+            for(auto& entry : stages)
+            {
+                Stage& stage = entry.second;
+                stage.recent = std::max(stage.frame, stage.recent * PROFILER_DECAY);
+                stage.frame = 0;
+            }
+        }
+
+        // The stages that took longest in a frame lately, slowest first
+        std::vector<Stage> slowest(std::size_t count) const
+        {
+            std::vector<Stage> out = sorted(&Stage::recent);
+            if(out.size() > count) out.resize(count);
+            return out;
+        }
+
+        // Frame time under which this percent of frames fall, p from 0 to 100.
+        // Only as exact as the bucket width.
+        double framePercentile(double p) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::uintmax_t total = 0;
+            for(std::uintmax_t n : histogram) total += n;
+            if(total == 0) return 0;
+
+            const double wanted = p / 100 * total;
+            std::uintmax_t seen = 0;
+            for(IntType i = 0; i < PROFILER_BUCKETS; ++i)
+            {
+                seen += histogram[i];
+                if(seen >= wanted) return (i + 1) * PROFILER_BUCKET_MS;
+            }
+            return PROFILER_BUCKETS * PROFILER_BUCKET_MS;
+        }
+
+        void report(std::ostream& out) const
+        {
+            for(const Stage& stage : sorted(&Stage::total))
+            {
+                out << stage.name << ": " << stage.count << " calls, " << stage.total / stage.count
+                    << "ms average, " << stage.worst << "ms worst, " << stage.total << "ms total\n";
+            }
+            out << "Frame time: p50 " << framePercentile(50) << "ms, p90 " << framePercentile(90)
+                << "ms, p99 " << framePercentile(99) << "ms\n";
+        }
+
+        // Trace Event Format, times are microseconds since the first event
+        void writeTrace(std::ostream& out) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const TimePoint origin = events.empty() ? TimePoint() : events.front().start;
+
+            out << "{\"traceEvents\":[";
+            for(std::size_t i = 0; i < events.size(); ++i)
+            {
+                const Event& event = events[i];
+                out << (i == 0 ? "\n" : ",\n")
+                    << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+                    << ",\"ts\":" << Microseconds(event.start - origin)
+                    << ",\"dur\":" << Microseconds(event.end - event.start) << '}';
+            }
+            out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        }
+
+    private:
+        Recorder() {}
+
+        struct Event
+        {
+            const char* name;
+            TimePoint start, end;
+            IntType thread;
+        };
+
+        static double Milliseconds(CHRONO_CLOCK::duration time)
+        {
+            return std::chrono::duration<double, std::milli>(time).count();
+        }
+
+        static double Microseconds(CHRONO_CLOCK::duration time)
+        {
+            return std::chrono::duration<double, std::micro>(time).count();
+        }
+
+        // Small numbers for threads, in the order they first record anything
+        static IntType ThreadIndex()
+        {
+            static std::atomic<IntType> nextThread{0};
+            thread_local const IntType index = nextThread++;
+            return index;
+        }
+
+        std::vector<Stage> sorted(double Stage::*by) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<Stage> out;
+            for(const auto& entry : stages) out.push_back(entry.second);
+            std::sort(out.begin(), out.end(),
+                [by](const Stage& a, const Stage& b) { return a.*by > b.*by; });
+            return out;
+        }
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Stage> stages;
+        std::vector<Event> events;
+
+        std::uintmax_t histogram[PROFILER_BUCKETS] = {};
+        std::uintmax_t frames = 0;
+        TimePoint lastFrame;
+    };
+
+    // Times everything until the end of the scope it's in
+    class Scope
+    {
+    public:
+        explicit Scope(const char* inName) : name(inName), start(CHRONO_CLOCK::now()) {}
+        ~Scope() { Recorder::Get().record(name, start, CHRONO_CLOCK::now()); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        Recorder::TimePoint start;
+    };
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PROFILER_ENABLED
+    #define PROFILE_SCOPE(name) const Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+    #define PROFILE_FRAME() Profiler::Recorder::Get().frame()
+#else
+    #define PROFILE_SCOPE(name) ((void)0)
+    #define PROFILE_FRAME() ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,219 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "./Constants.h"
+#include "./Game.h"
+#include "./Input.h"
+
+#include <vector> // Input runs
+
+/* ***** REPLAY FILE STRUCTURE *****
+ * [32bit Magic Number] = 0x53616d52 // Spells "SamR"
+ * [32bit Version]
+ * [64bit Level Hash] <--- updateLevelHash() when recording started
+ * [32bit Tick Count]
+ * [32bit Final Frame]
+ * [32bit Final Deaths]
+ * [32bit Final Coins]
+ * [RUN DATA] ...
+ *
+ * Each run is two LEB128 numbers, how many ticks the input was held
+ * and the input XOR'd with the input of the run before it.
+ * Like the .lvl, everything is stored little endian.
+ */
+namespace Replay
+{
+    static constexpr RawIntType REPLAY_MAGIC_NUMBER = 0x53616d52; // "SamR"
+    static constexpr RawIntType REPLAY_VERSION = 1;
+
+    // What a replay has to reproduce
+    struct Summary
+    {
+        HashType hash = 0;
+        RawIntType ticks = 0;
+        IntType frame = 0, deaths = 0, coins = 0;
+
+        static Summary Capture(const Game& game, RawIntType ticks)
+        {
+            Summary out;
+            out.hash = game.getLevelHash();
+            out.ticks = ticks;
+            out.frame = game.getFrame();
+            out.deaths = game.getDeaths();
+            out.coins = game.getCoins();
+            return out;
+        }
+
+        bool matches(const Summary& other) const
+        {
+            return hash == other.hash
+                && frame == other.frame
+                && deaths == other.deaths
+                && coins == other.coins;
+        }
+    };
+
+    struct Run
+    {
+        InputType buttons;
+        RawIntType length;
+    };
+
+    static void WriteNumber(std::ostream& file, HashType num, IntType bytes)
+    {
+        for(IntType i = 0; i < bytes; ++i)
+            file.put(char((num >> (8*i)) & 0xff));
+    }
+
+    static HashType ReadNumber(std::istream& file, IntType bytes)
+    {
+        HashType out = 0;
+        for(IntType i = 0; i < bytes; ++i)
+            out |= HashType(Byte(file.get())) << (8*i);
+        return out;
+    }
+
+    static void WriteVarInt(std::ostream& file, RawIntType num)
+    {
+        while(num >= 0x80)
+        {
+            file.put(char((num & 0x7f) | 0x80));
+            num >>= 7;
+        }
+        file.put(char(num));
+    }
+
+    static RawIntType ReadVarInt(std::istream& file)
+    {
+        RawIntType out = 0;
+        for(IntType shift = 0; shift < 35 && file.good(); shift += 7)
+        {
+            const Byte part = Byte(file.get());
+            out |= RawIntType(part & 0x7f) << shift;
+            if((part & 0x80) == 0) break;
+        }
+        return out;
+    }
+
+    // Wraps another source and keeps everything it hands to the game
+    class Recorder : public Input::Source
+    {
+    public:
+        explicit Recorder(Input::Source& inSource) : source(&inSource) {}
+
+        // Keeps recording from somewhere else, like live input once a replay ends
+        void setSource(Input::Source& inSource) { source = &inSource; }
+
+        void begin(const Game& game)
+        {
+            runs.clear();
+            ticks = 0;
+            hash = game.getLevelHash();
+        }
+
+        Input::State poll() override
+        {
+            const Input::State state = source->poll();
+            if(!runs.empty() && runs.back().buttons == state.buttons)
+                ++runs.back().length;
+            else runs.push_back({state.buttons, 1});
+
+            ++ticks;
+            return state;
+        }
+
+        bool save(const std::string& fileName, const Game& game) const
+        {
+            std::ofstream file(fileName, std::ios::binary);
+            if(!file.good()) return false;
+
+            Summary summary = Summary::Capture(game, ticks);
+            summary.hash = hash;
+
+            WriteNumber(file, REPLAY_MAGIC_NUMBER, 4);
+            WriteNumber(file, REPLAY_VERSION, 4);
+            WriteNumber(file, summary.hash, 8);
+            WriteNumber(file, summary.ticks, 4);
+            WriteNumber(file, RawIntType(summary.frame), 4);
+            WriteNumber(file, RawIntType(summary.deaths), 4);
+            WriteNumber(file, RawIntType(summary.coins), 4);
+
+            InputType last = Input::Button::None;
+            for(const Run& run : runs)
+            {
+                WriteVarInt(file, run.length);
+                WriteVarInt(file, run.buttons ^ last);
+                last = run.buttons;
+            }
+
+            return file.good();
+        }
+
+    private:
+        Input::Source* source;
+        std::vector<Run> runs;
+        RawIntType ticks = 0;
+        HashType hash = 0;
+    };
+
+    // Feeds a recording back into the game, then goes idle
+    class Player : public Input::Source
+    {
+    public:
+        bool load(const std::string& fileName)
+        {
+            std::ifstream file(fileName, std::ios::binary);
+            if(!file.good()) return false;
+
+            if(ReadNumber(file, 4) != REPLAY_MAGIC_NUMBER) return false;
+            if(ReadNumber(file, 4) != REPLAY_VERSION) return false;
+            expected.hash = ReadNumber(file, 8);
+            expected.ticks = RawIntType(ReadNumber(file, 4));
+            expected.frame = IntType(ReadNumber(file, 4));
+            expected.deaths = IntType(ReadNumber(file, 4));
+            expected.coins = IntType(ReadNumber(file, 4));
+
+            runs.clear();
+            InputType last = Input::Button::None;
+            for(RawIntType total = 0; total < expected.ticks;)
+            {
+                const RawIntType length = ReadVarInt(file);
+                const InputType buttons = InputType(ReadVarInt(file) ^ last);
+                if(!file.good() || length == 0) return false;
+
+                runs.push_back({buttons, length});
+                total += length;
+                last = buttons;
+            }
+
+            run = 0;
+            used = 0;
+            played = 0;
+            return true;
+        }
+
+        Input::State poll() override
+        {
+            Input::State state;
+            if(run < runs.size())
+            {
+                state.buttons = runs[run].buttons;
+                if(++used >= runs[run].length) { ++run; used = 0; }
+                ++played;
+            }
+            return state;
+        }
+
+        bool done() const { return run >= runs.size(); }
+        RawIntType getTicks() const { return played; }
+        const Summary& getExpected() const { return expected; }
+
+    private:
+        std::vector<Run> runs;
+        std::size_t run = 0;
+        RawIntType used = 0, played = 0;
+        Summary expected;
+    };
+}
+
+#endif // REPLAY_H
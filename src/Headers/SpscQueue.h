@@ -0,0 +1,45 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include "Constants.h"
+
+#include <atomic> // Head and tail
+
+// Fixed size queue between exactly one thread pushing and one thread
+// popping. Neither side ever waits, a full queue just refuses the push.
+template<class T, std::size_t SIZE>
+class SpscQueue
+{
+    static_assert(SIZE != 0 && (SIZE & (SIZE - 1)) == 0, "Queue size has to be a power of 2");
+
+public:
+    // Pushing thread only
+    bool push(const T& item)
+    {
+        const std::size_t back = head.load(std::memory_order_relaxed);
+        if(back - tail.load(std::memory_order_acquire) == SIZE) return false;
+
+        items[back & (SIZE - 1)] = item;
+        head.store(back + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Popping thread only
+    bool pop(T& item)
+    {
+        const std::size_t front = tail.load(std::memory_order_relaxed);
+        if(head.load(std::memory_order_acquire) == front) return false;
+
+        item = items[front & (SIZE - 1)];
+        tail.store(front + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // On their own cache lines so the two threads don't fight over them
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+    T items[SIZE];
+};
+
+#endif // SPSC_QUEUE_H
@@ -3,105 +3,282 @@
 
 #include "./Constants.h"
 #include "./Game.h"
+#include "./Assets.h"
+#include "./Profiler.h"
 
+#include <array> // Values the timer shows
+#include <cstdio> // Formatting numbers
+#include <vector> // Values the leaderboard shows
+
+// The HUD only rebuilds a string when something it shows has changed.
+// sf::Text keeps its glyph layout until setString is called again, so
+// unchanged text costs nothing but the draw.
 namespace TextTimes
 {
-    const char* Base32 = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
-    static void UpdateHash(const Game& game, sf::Text& text)
+    static constexpr char BASE32[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+    /**********************/
+    /***** FORMATTING *****/
+    /**********************/
+
+    static void AppendNumber(std::string& out, IntType num)
     {
-        // Setup string buffer
-        std::ostringstream stream;
-        stream << GAME_VERSION << " : ";
-        HashType gameHash = game.getLevelHash();
-        while(gameHash != 0)
-        {
-            stream << Base32[gameHash & 0x1f];
-            gameHash >>= 5;
-        }
+        char digits[16];
+        const int length = std::snprintf(digits, sizeof(digits), "%d", int(num));
+        out.append(digits, length);
+    }
 
-        text.setPosition(6, 6 + GAME_SCALE*(GAME_HEIGHT - 1));
-        text.setString(stream.str());
+    // Same as streaming with std::fixed and std::setprecision(precision)
+    static void AppendFixed(std::string& out, double num, IntType precision)
+    {
+        char digits[32];
+        const int length = std::snprintf(digits, sizeof(digits), "%.*f", int(precision), num);
+        out.append(digits, length);
     }
 
-    static void UpdateTimer(const Game& game, sf::Text& text)
+    /*******************/
+    /***** HUD TEXT ****/
+    /*******************/
+
+    class Hud
     {
-        std::ostringstream stream;
-        if(game.getCheater())
-        { 
-            text.setFillColor(BAD_COLOR);
-            if(game.getFlying())
-                stream << "(Flying)\n";
-            else stream << "(Cheats Used)\n";
-        } else {
-            text.setFillColor(GOOD_COLOR);
+    public:
+        Hud() : leaderboard(GET_DEFAULT_TEXT(1)), timer(GET_DEFAULT_TEXT(1)), version(GET_DEFAULT_TEXT(1))
+        {
+            version.setPosition(6, 6 + GAME_SCALE*(GAME_HEIGHT - 1));
         }
 
-        stream << std::setprecision(4) << std::fixed;
-        stream << "Time: " << (double(game.getFrame()) / double(GAME_FPS)) << "s\n";
-        stream << "Total Coins: " << game.getCoins() << " / " << game.getMaxCoins() << '\n';
-        if(!game.getWinner())
-        {   
-            stream << "Level Coins: " 
-                << game.getLevelCoins(game.getLevel()) << " / " 
-                << game.getLevelMaxCoins(game.getLevel())  << '\n';
+        // Text tied to the level is placed with the camera the world was
+        // drawn with, slid between ticks, so it moves with the level
+        void update(const Game& game, double cameraX, double cameraY)
+        {
+            PROFILE_SCOPE("hudUpdate");
+            updateHash(game);
+            updateLeaderboard(game, float(cameraX), float(cameraY));
+            updateTimer(game, float(cameraX));
         }
 
-        stream << "Deaths: " << game.getDeaths() << '\n';
-        text.setString(stream.str());
-        text.setPosition(6 + std::max(GAME_SCALE * (1 + START_SIZE - game.getCameraX()), 0), 0);
-    }
+        void draw(sf::RenderWindow& app) const
+        {
+            PROFILE_SCOPE("hudDraw");
+            app.draw(leaderboard);
+            app.draw(timer);
+            app.draw(version);
+        }
 
-    static void UpdateLeaderboard(const Game& game, sf::Text& text)
-    {
-        text.setPosition(GAME_SCALE * (TEXT_X - game.getCameraX()), GAME_SCALE * TEXT_Y);
+    private:
+        enum class Board { Unset, Times, Controls, Empty };
+
+        void updateHash(const Game& game)
+        {
+            const HashType key = game.getLevelHash();
+            if(hasHash && key == hashKey) return;
+            hasHash = true;
+            hashKey = key;
+
+            scratch = GAME_VERSION;
+            scratch += " : ";
+            for(HashType gameHash = key; gameHash != 0; gameHash >>= 5)
+                scratch += BASE32[gameHash & 0x1f];
+
+            version.setString(scratch);
+        }
 
-        // Leader Board
-        if(game.getCameraX() < START_SIZE 
-        && game.getLevel() != START_LEVEL)
+        void updateTimer(const Game& game, float cameraX)
         {
-            // Setup string buffer
-            std::ostringstream stream;
-            stream << std::setprecision(2) << std::fixed;
-            stream << "Times:\n"; 
-            
+            const float x = 6 + std::max(GAME_SCALE * (1 + START_SIZE - cameraX), 0.f);
+            if(x != timerX)
+            {
+                timerX = x;
+                timer.setPosition(x, 0);
+            }
+
+            const TimerValues values = {
+                game.getCheater(), game.getFlying(), game.getWinner(),
+                game.getFrame(), game.getCoins(), game.getMaxCoins(),
+                game.getLevelCoins(game.getLevel()), game.getLevelMaxCoins(game.getLevel()),
+                game.getDeaths()
+            };
+            if(hasTimer && values == timerValues) return;
+            hasTimer = true;
+            timerValues = values;
+
+            scratch.clear();
             if(game.getCheater())
-                text.setFillColor(BAD_COLOR);
-            else text.setFillColor(GOOD_COLOR); 
+            {
+                timer.setFillColor(BAD_COLOR);
+                if(game.getFlying())
+                    scratch += "(Flying)\n";
+                else scratch += "(Cheats Used)\n";
+            } else {
+                timer.setFillColor(GOOD_COLOR);
+            }
+
+            scratch += "Time: ";
+            AppendFixed(scratch, double(game.getFrame()) / double(GAME_FPS), 4);
+            scratch += "s\nTotal Coins: ";
+            AppendNumber(scratch, game.getCoins());
+            scratch += " / ";
+            AppendNumber(scratch, game.getMaxCoins());
+            scratch += '\n';
+            if(!game.getWinner())
+            {
+                scratch += "Level Coins: ";
+                AppendNumber(scratch, game.getLevelCoins(game.getLevel()));
+                scratch += " / ";
+                AppendNumber(scratch, game.getLevelMaxCoins(game.getLevel()));
+                scratch += '\n';
+            }
 
+            scratch += "Deaths: ";
+            AppendNumber(scratch, game.getDeaths());
+            scratch += '\n';
+            timer.setString(scratch);
+        }
+
+        void updateLeaderboard(const Game& game, float cameraX, float cameraY)
+        {
+            if(cameraX != leaderboardX || cameraY != leaderboardY)
+            {
+                leaderboardX = cameraX;
+                leaderboardY = cameraY;
+                leaderboard.setPosition(GAME_SCALE * (TEXT_X - cameraX), GAME_SCALE * (TEXT_Y - cameraY));
+            }
+
+            Board board = Board::Empty;
+            if(game.getCameraX() < START_SIZE && game.getLevel() != START_LEVEL) board = Board::Times;
+            else if(game.getLevel() == START_LEVEL) board = Board::Controls;
+
+            if(board == Board::Times) updateTimes(game);
+            else if(board != shownBoard)
+            {
+                if(board == Board::Controls)
+                {
+                    leaderboard.setString(
+                        "\n" /* Controls */
+                        "-----= Controls =-----\n"
+                        " Space Bar = Jump\n"
+                        " WASD / Arrows = Move\n\n"
+                        " Ctrl + Shift:\n"
+                        "   + S = Toggle Sound\n"
+                        "   + M = Toggle Music\n"
+                        "   + E = Level Editor\n"
+                    );
+                    leaderboard.setFillColor(GOOD_COLOR);
+                } else leaderboard.setString("");
+            }
+
+            shownBoard = board;
+        }
+
+        void updateTimes(const Game& game)
+        {
             const IntType startLevel = std::max(game.getFinalLevel() - 10, IntType(1));
             const IntType endLevel = game.getWinner() ? game.getFinalLevel() : game.getLevel() - 1;
-            
+
+            // Finished levels hardly ever change, so this is usually all that runs
+            timesScratch.clear();
+            timesScratch.push_back(game.getCheater());
+            timesScratch.push_back(startLevel);
+            timesScratch.push_back(endLevel);
+            for(IntType i = startLevel; i <= endLevel; ++i)
+            {
+                timesScratch.push_back(game.getLevelFrame(i));
+                timesScratch.push_back(game.getLevelCoins(i));
+                timesScratch.push_back(game.getLevelMaxCoins(i));
+            }
+            if(shownBoard == Board::Times && timesScratch == timesValues) return;
+            timesValues.swap(timesScratch);
+
+            if(game.getCheater())
+                leaderboard.setFillColor(BAD_COLOR);
+            else leaderboard.setFillColor(GOOD_COLOR);
+
+            scratch = "Times:\n";
             for(IntType i = startLevel; i <= endLevel; ++i)
             {
                 // Balance Level Sign
-                stream << "L" << i << ": ";
-                if(i < 10) { stream << " "; }
-                
+                scratch += 'L';
+                AppendNumber(scratch, i);
+                scratch += ": ";
+                if(i < 10) { scratch += ' '; }
+
                 // Calculate Time
-                stream << double(game.getLevelFrame(i)) / double(GAME_FPS) << 's';
-                stream << " (" << game.getLevelCoins(i) << " / " << game.getLevelMaxCoins(i) << ')';
-                stream << '\n';
+                AppendFixed(scratch, double(game.getLevelFrame(i)) / double(GAME_FPS), 2);
+                scratch += "s (";
+                AppendNumber(scratch, game.getLevelCoins(i));
+                scratch += " / ";
+                AppendNumber(scratch, game.getLevelMaxCoins(i));
+                scratch += ")\n";
             }
 
             // Print times to leader board
-            text.setString(stream.str());
-        } else if(game.getLevel() == START_LEVEL) 
+            leaderboard.setString(scratch);
+        }
+
+        sf::Text leaderboard, timer, version;
+
+        // Reused for every string so building one doesn't allocate
+        std::string scratch;
+
+        // What each text was last built from
+        using TimerValues = std::array<IntType, 9>;
+        bool hasHash = false, hasTimer = false;
+        HashType hashKey = 0;
+        TimerValues timerValues = {};
+        std::vector<IntType> timesValues, timesScratch;
+        Board shownBoard = Board::Unset;
+        float timerX = -1, leaderboardX = -1, leaderboardY = -1;
+    };
+
+    /****************************/
+    /***** PROFILER OVERLAY *****/
+    /****************************/
+
+    // The stages that took longest in a frame lately, only has
+    // anything to show in a build with PROFILER_ENABLED
+    class ProfileOverlay
+    {
+    public:
+        static constexpr std::size_t STAGES = 6;
+
+        ProfileOverlay() : text(GET_DEFAULT_TEXT(0.75))
         {
-            // Setup string buffer
-            std::ostringstream stream;
-            stream << '\n' /* Controls */
-                << "-----= Controls =-----\n"
-                << " Space Bar = Jump\n"
-                << " WASD / Arrows = Move\n\n"
-                << " Ctrl + Shift:\n"
-                << "   + S = Toggle Sound\n"
-                << "   + M = Toggle Music\n"
-                << "   + E = Level Editor\n";
-            text.setString(stream.str());
-            text.setFillColor(GOOD_COLOR);
-        } else
-        { text.setString(""); }
-    }
+            text.setPosition(6, GAME_SCALE*3);
+        }
+
+        void toggle() { shown = !shown; }
+
+        void update()
+        {
+            if(!shown) return;
+
+            scratch = "Slowest stages:\n";
+            for(const Profiler::Stage& stage : Profiler::Recorder::Get().slowest(STAGES))
+            {
+                scratch += stage.name;
+                scratch += ' ';
+                AppendFixed(scratch, stage.recent, 2);
+                scratch += "ms\n";
+            }
+
+            if(scratch != lastString)
+            {
+                text.setString(scratch);
+                lastString = scratch;
+            }
+        }
+
+        void draw(sf::RenderWindow& app) const
+        {
+            if(shown) app.draw(text);
+        }
+
+    private:
+        sf::Text text;
+        std::string scratch, lastString;
+        bool shown = false;
+    };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -2,22 +2,117 @@
 #define WINDOW_H
 
 #include "Constants.h"
+#include "Profiler.h"
+
+#include <cstring> // Comparing rows
+#include <iostream> // Frame limit fallback
 
 namespace Graphics
 {
-    void pushRGBA(sf::RenderWindow& app, const Byte* pixels)
+    // Owns the one texture the world is drawn with for the life of the window,
+    // and only sends the rows that changed since the last frame to the GPU.
+    // Between ticks the picture is slid by part of a block, and the texture's
+    // edge pixels are stretched over the gap it leaves.
+    class Renderer
     {
-        app.clear();
+    public:
+        static constexpr std::size_t ROW_BYTES = GAME_WIDTH*4;
+
+        Renderer()
+        {
+            texture.create(GAME_WIDTH, GAME_HEIGHT);
+            sprite.setTexture(texture);
+            sprite.setTextureRect(sf::IntRect(-MAX_INTERPOLATE, -MAX_INTERPOLATE,
+                GAME_WIDTH + 2*MAX_INTERPOLATE, GAME_HEIGHT + 2*MAX_INTERPOLATE));
+            sprite.setScale(GAME_SCALE,GAME_SCALE);
+
+            block.setSize(sf::Vector2f(GAME_SCALE, GAME_SCALE));
+        }
+
+        // shiftX and shiftY move the picture by that many blocks
+        void pushRGBA(sf::RenderWindow& app, const Byte* pixels, float shiftX = 0, float shiftY = 0)
+        {
+            PROFILE_SCOPE("pushRGBA");
+            app.clear();
+
+            // Upload each run of changed rows as one rectangle
+            lastUpload = 0;
+            for(RawIntType y = 0; y < GAME_HEIGHT;)
+            {
+                if(!rowChanged(pixels, y)) { ++y; continue; }
+
+                RawIntType end = y + 1;
+                while(end < GAME_HEIGHT && rowChanged(pixels, end)) ++end;
+
+                texture.update(pixels + y*ROW_BYTES, GAME_WIDTH, end - y, 0, y);
+                std::memcpy(&uploaded[y][0][0], pixels + y*ROW_BYTES, (end - y)*ROW_BYTES);
+                lastUpload += (end - y)*ROW_BYTES;
+                y = end;
+            }
+
+            hasUploaded = true;
+            totalUpload += lastUpload;
+            ++frames;
+
+            sprite.setPosition((shiftX - MAX_INTERPOLATE)*GAME_SCALE, (shiftY - MAX_INTERPOLATE)*GAME_SCALE);
+            app.draw(sprite);
+        }
+
+        // One block at a position on the screen, in blocks
+        void drawBlock(sf::RenderWindow& app, float x, float y, sf::Color color)
+        {
+            block.setPosition(x*GAME_SCALE, y*GAME_SCALE);
+            block.setFillColor(color);
+            app.draw(block);
+        }
+
+        // Shows the frame. Vsync is only a request that drivers can ignore, if
+        // frames keep coming faster than any display shows them, SFML's frame
+        // limit takes over
+        void display(sf::RenderWindow& app)
+        {
+            app.display();
+            if(limited) return;
+
+            const CHRONO_CLOCK::time_point now = CHRONO_CLOCK::now();
+            fastFrames = (now - lastDisplay) * MAX_FRAME_RATE < std::chrono::seconds(1) ? fastFrames + 1 : 0;
+            lastDisplay = now;
+
+            if(fastFrames >= VSYNC_CHECK_FRAMES)
+            {
+                app.setVerticalSyncEnabled(false);
+                app.setFramerateLimit(MAX_FRAME_RATE);
+                limited = true;
+                std::clog << "Vsync isn't working, frames are limited to " << MAX_FRAME_RATE << " a second\n";
+            }
+        }
+
+        // Bytes sent to the GPU last frame and since the window opened
+        std::uintmax_t getLastUploadBytes() const { return lastUpload; }
+        std::uintmax_t getTotalUploadBytes() const { return totalUpload; }
+        std::uintmax_t getFrames() const { return frames; }
+
+    private:
+        bool rowChanged(const Byte* pixels, RawIntType y) const
+        {
+            return !hasUploaded || std::memcmp(&uploaded[y][0][0], pixels + y*ROW_BYTES, ROW_BYTES) != 0;
+        }
+
+        sf::Texture texture;
+        sf::Sprite sprite;
+        sf::RectangleShape block;
 
-        sf::Texture buffer;
-        buffer.create(GAME_WIDTH, GAME_HEIGHT);
-        buffer.update(pixels);
+        // What the GPU already has
+        Byte uploaded[GAME_HEIGHT][GAME_WIDTH][4] = {};
+        bool hasUploaded = false;
 
-        sf::Sprite temp(buffer);
-        temp.setScale(GAME_SCALE,GAME_SCALE);
+        std::uintmax_t lastUpload = 0, totalUpload = 0, frames = 0;
 
-        app.draw(temp);
-    }
+        // Frame limit fallback
+        CHRONO_CLOCK::time_point lastDisplay;
+        IntType fastFrames = 0;
+        bool limited = false;
+    };
 };
 
 #endif // WINDOW_H
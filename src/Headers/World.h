@@ -0,0 +1,253 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "./Constants.h"
+#include "./FileLoader.h"
+
+#include <cstring> // Copying chunks
+#include <memory> // Chunk buffers
+#include <vector> // Chunk table
+
+// A level of any length and height, kept as chunks of CHUNK_WIDTH columns.
+// Chunks are read from the level file the first time they're touched, and
+// once more than WORLD_MEMORY_BUDGET is in memory the least recently used
+// ones are dropped again. A chunk that has been written to can't be read
+// back from the file, so it stays until another level is loaded. The chunks
+// the last prefetch() asked for are never dropped either, so a level tall
+// enough that they don't fit the budget goes over it instead of reading
+// them again for every cell.
+class World
+{
+public:
+    using Cells = std::unique_ptr<GameType[]>;
+
+    World() { blank(); }
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    // Reads a level's header, its chunks are read as they're needed
+    bool load(const IntType lvl)
+    {
+        if(!file.open(lvl)) return false;
+        resize(file.getLength(), file.getHeight());
+        source = lvl;
+        return true;
+    }
+
+    // Reads all of another file, like an autosave, as unsaved edits to lvl
+    bool loadEdits(const IntType lvl, const std::string& path)
+    {
+        Loader::LevelFile edits;
+        if(!edits.open(path)) return false;
+
+        file.close();
+        resize(edits.getLength(), edits.getHeight());
+        source = lvl;
+        for(RawIntType i = 0; i < chunks.size(); ++i)
+        {
+            edits.readChunk(i, create(i).get());
+            chunks[i].dirty = true;
+        }
+        return true;
+    }
+
+    // Same as load() for a header that was already read, the file
+    // isn't opened until a chunk is missing
+    void open(const IntType lvl, const RawIntType inLength, const RawIntType inHeight)
+    {
+        file.close();
+        resize(inLength, inHeight);
+        source = lvl;
+    }
+
+    // Hands over a chunk that was already read
+    void adopt(const RawIntType index, const GameType* cells)
+    {
+        if(index >= chunks.size() || chunks[index].cells) return;
+        std::memcpy(create(index).get(), cells, chunkBytes());
+    }
+
+    // The empty level new levels start as
+    void blank(const RawIntType inLength = GAME_LENGTH, const RawIntType inHeight = GAME_HEIGHT)
+    {
+        file.close();
+        resize(inLength, inHeight);
+        source = -1;
+
+        for(RawIntType i = 0; i < chunks.size(); ++i)
+        {
+            create(i);
+            chunks[i].dirty = true;
+        }
+
+        for(RawIntType x = 0; x < length; ++x)
+        {
+            for(RawIntType y = 0; y < height; ++y)
+            {
+                GameType& cell = at(x, y);
+                if(IntType(x) <= START_SIZE && y <= 7)
+                {
+                    if(IntType(x) == START_SIZE || y == 7)
+                        cell = GameType::Trap;
+                    else cell = GameType::Sky;
+                } else cell = (y + 3 >= height) ? GameType::Ground : GameType::Sky;
+            }
+        }
+    }
+
+    // Every block, for writing somewhere else. The world isn't marked
+    // as saved, so edits stay in memory until another level is loaded.
+    Loader::LevelData copy() const
+    {
+        Loader::LevelData out;
+        out.length = length;
+        out.height = height;
+        out.cells.resize(chunks.size() * chunkBytes());
+        for(RawIntType i = 0; i < chunks.size(); ++i)
+        {
+            if(!chunks[i].cells) pageIn(i, false);
+            std::memcpy(&out.cells[i * out.chunkSize()], chunks[i].cells.get(), chunkBytes());
+        }
+
+        // Let go of the file so it can be replaced, it's opened again if a chunk is dropped
+        file.close();
+        trim();
+        return out;
+    }
+
+    // Off the edges of the level is the nearest cell inside it
+    GameType get(const IntType x, const IntType y) const
+    {
+        return at(Clamp(x, length), Clamp(y, height));
+    }
+
+    GameType& ref(const IntType x, const IntType y)
+    {
+        const RawIntType cx = Clamp(x, length);
+        touch(cx / CHUNK_WIDTH).dirty = true;
+        return at(cx, Clamp(y, height));
+    }
+
+    // Reads the chunks covering these columns before they're drawn, and keeps
+    // them until the next prefetch. Call it once a frame for what's in view,
+    // single reads don't mark anything so they stay cheap.
+    void prefetch(const IntType first, const IntType last) const
+    {
+        const RawIntType begin = Clamp(first, length) / CHUNK_WIDTH;
+        const RawIntType end = Clamp(last, length) / CHUNK_WIDTH;
+        pinned = ++useClock;
+        for(RawIntType i = begin; i <= end; ++i) touch(i).lastUse = useClock;
+    }
+
+    RawIntType getLength() const { return length; }
+    RawIntType getHeight() const { return height; }
+    std::size_t getResidentBytes() const { return residentBytes; }
+    std::uintmax_t getChunkReads() const { return chunkReads; }
+
+private:
+    struct Chunk
+    {
+        Cells cells;
+        bool dirty = false;
+        std::uint64_t lastUse = 0;
+    };
+
+    static RawIntType Clamp(const IntType value, const RawIntType size)
+    {
+        return RawIntType(std::min(std::max(value, IntType(0)), IntType(size - 1)));
+    }
+
+    std::size_t chunkBytes() const
+    {
+        return std::size_t(CHUNK_WIDTH) * height * sizeof(GameType);
+    }
+
+    GameType& at(const RawIntType x, const RawIntType y) const
+    {
+        return touch(x / CHUNK_WIDTH).cells[(x % CHUNK_WIDTH) * height + y];
+    }
+
+    Chunk& touch(const RawIntType index) const
+    {
+        Chunk& chunk = chunks[index];
+        if(!chunk.cells) pageIn(index, true);
+        return chunk;
+    }
+
+    void resize(const RawIntType inLength, const RawIntType inHeight)
+    {
+        length = std::max(inLength, RawIntType(1));
+        height = std::max(inHeight, RawIntType(1));
+
+        chunks.clear();
+        chunks.resize((length + CHUNK_WIDTH - 1) / CHUNK_WIDTH);
+        resident.clear();
+        residentBytes = 0;
+        useClock = 0;
+        pinned = NOT_PINNED;
+    }
+
+    Cells& create(const RawIntType index) const
+    {
+        Chunk& chunk = chunks[index];
+        chunk.cells.reset(new GameType[std::size_t(CHUNK_WIDTH) * height]);
+        chunk.dirty = false;
+        chunk.lastUse = ++useClock;
+
+        resident.push_back(index);
+        residentBytes += chunkBytes();
+        return chunk.cells;
+    }
+
+    void pageIn(const RawIntType index, const bool evict) const
+    {
+        if(evict) trim(chunkBytes());
+        GameType* cells = create(index).get();
+        ++chunkReads;
+
+        // A file that changed size since the header was read is ignored
+        if(!file.isOpen() && source >= 0) file.open(source);
+        if(!file.isOpen() || file.getLength() != length || file.getHeight() != height
+        || !file.readChunk(index, cells))
+            std::fill(cells, cells + std::size_t(CHUNK_WIDTH) * height, GameType::Sky);
+    }
+
+    // Drops the least recently used clean chunks until extra bytes fit,
+    // leaving the ones used since the last prefetch
+    void trim(const std::size_t extra = 0) const
+    {
+        while(residentBytes + extra > WORLD_MEMORY_BUDGET)
+        {
+            std::size_t oldest = resident.size();
+            for(std::size_t i = 0; i < resident.size(); ++i)
+            {
+                const Chunk& chunk = chunks[resident[i]];
+                if(!chunk.dirty && chunk.lastUse < pinned && (oldest == resident.size()
+                || chunk.lastUse < chunks[resident[oldest]].lastUse))
+                    oldest = i;
+            }
+            if(oldest == resident.size()) return;
+
+            chunks[resident[oldest]].cells.reset();
+            resident[oldest] = resident.back();
+            resident.pop_back();
+            residentBytes -= chunkBytes();
+        }
+    }
+
+    RawIntType length = 0, height = 0;
+    IntType source = -1; // Level the chunks are read from
+
+    // Paging happens on reads, so all of this changes in const methods
+    mutable Loader::LevelFile file;
+    mutable std::vector<Chunk> chunks;
+    mutable std::vector<RawIntType> resident;
+    mutable std::size_t residentBytes = 0;
+    mutable std::uint64_t useClock = 0;
+    mutable std::uint64_t pinned = NOT_PINNED; // Chunks used at or after this are kept
+    mutable std::uintmax_t chunkReads = 0; // Chunks read from the file or made blank
+
+    static constexpr std::uint64_t NOT_PINNED = ~std::uint64_t(0);
+};
+
+#endif // WORLD_H
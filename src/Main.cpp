@@ -1,72 +1,204 @@
 #include "./Headers/Constants.h"
 #include "./Headers/Window.h"
 #include "./Headers/Game.h"
+#include "./Headers/FrameContext.h"
+#include "./Headers/FixedStep.h"
+#include "./Headers/Input.h"
+#include "./Headers/Latency.h"
+#include "./Headers/Audio.h"
+#include "./Headers/Assets.h"
+#include "./Headers/Replay.h"
 #include "./Headers/LevelBuilder.h"
 #include "./Headers/TextTimes.h"
+#include "./Headers/Profiler.h"
 
-int main()
+#include <iostream> // Replay results, frame times
+#include <fstream> // Profile trace
+
+// "--record FILE" saves the run when the window closes
+// "--replay FILE" plays a run back at GAME_FPS, then hands control back
+// "--noise exact" draws textures the slow way, to compare against older builds
+// "--profile FILE" saves a trace for chrome://tracing, in a PROFILER_ENABLED build
+int main(int argc, char** argv)
 {
+    std::string recordFile, replayFile, profileFile;
+    for(IntType i = 1; i + 1 < argc; i += 2)
+    {
+        if(std::string(argv[i]) == "--record") recordFile = argv[i + 1];
+        else if(std::string(argv[i]) == "--replay") replayFile = argv[i + 1];
+        else if(std::string(argv[i]) == "--noise") Noise::Field::SetExact(std::string(argv[i + 1]) == "exact");
+        else if(std::string(argv[i]) == "--profile") profileFile = argv[i + 1];
+    }
+
+    if(!profileFile.empty() && !Profiler::ENABLED)
+        std::cerr << "Built without PROFILER_ENABLED, there won't be a profile\n";
+
+    // Fonts and sounds load while the window opens
+    const auto startup = CHRONO_CLOCK::now();
+    Assets::Get().preload();
+    bool reportedAssets = false;
+
     // Game Window
     sf::ContextSettings settings;
     settings.antialiasingLevel = 16;
     sf::RenderWindow app(sf::VideoMode(GAME_WIDTH*GAME_SCALE, GAME_HEIGHT*GAME_SCALE), 
                          "Upside Down", sf::Style::Default, settings);
-    app.setFramerateLimit(GAME_FPS);
+    app.setVerticalSyncEnabled(true);
+    Graphics::Renderer renderer;
+
+    // The game ticks at GAME_FPS however fast frames are drawn
+    FixedStep timestep;
 
     Game game;
+    Audio audio;
+    Input::Tracker tracker; // Every window event goes through here
+    Input::Live live(tracker);
+    Input::Latency latency; // Press to screen, for live input only
+    Replay::Recorder recorder(live);
+    Replay::Player replay;
     bool focus = true;
     game.loadWorld(START_LEVEL);
+    recorder.begin(game);
+
+    // Everything the game is fed goes through the recorder, the replay
+    // first if there is one and then whoever is at the controls
+    bool replaying = false;
+    if(!replayFile.empty())
+    {
+        if(!replay.load(replayFile))
+        {
+            std::cerr << "Could not read replay " << replayFile << '\n';
+            return EXIT_FAILURE;
+        }
 
-    // Text class used to display times
-    sf::Text leaderboard = GET_DEFAULT_TEXT(1);
-    sf::Text timer = GET_DEFAULT_TEXT(1);
-    sf::Text version = GET_DEFAULT_TEXT(1);
-    TextTimes::UpdateHash(game, version);
+        if(replay.getExpected().hash != game.getLevelHash())
+            std::cerr << "Warning: replay was recorded on different levels, it won't match\n";
+
+        recorder.setSource(replay);
+        replaying = true;
+    }
+
+    // Times, coins and the level hash
+    TextTimes::Hud hud;
+    TextTimes::ProfileOverlay overlay; // F3
 
     while (app.isOpen())
     {
-        sf::Event event;
-        while (app.pollEvent(event))
+        FrameContext::Capture();
+
+        if(!reportedAssets && audio.isLoaded() && Assets::Get().isLoaded())
         {
-            // Close window : exit
-            if (event.type == sf::Event::Closed) app.close();
-            if (event.type == sf::Event::GainedFocus) 
-            {
-                game.overworldMusic.setVolume(OVERWORLD_VOL);
-                game.updateLevelHash();
-                focus = true;
-            }
-            if (event.type == sf::Event::LostFocus) 
+            std::clog << "Assets ready after " << std::chrono::duration<double, std::milli>(
+                CHRONO_CLOCK::now() - startup).count() << "ms\n";
+            Assets::Get().report(std::clog);
+            reportedAssets = true;
+        }
+
+        {
+            PROFILE_SCOPE("events");
+            sf::Event event;
+            while (app.pollEvent(event))
             {
-                game.overworldMusic.setVolume(OVERWORLD_VOL/5);
-                focus = false;
+                tracker.handle(event);
+
+                // Close window : exit
+                if (event.type == sf::Event::Closed) app.close();
+                if (event.type == sf::Event::GainedFocus) 
+                {
+                    audio.setFocus(true);
+                    game.updateLevelHash();
+                    focus = true;
+                }
+                if (event.type == sf::Event::LostFocus) 
+                {
+                    audio.setFocus(false);
+                    focus = false;
+                }
+                if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3)
+                    overlay.toggle();
             }
         }
 
-        if(focus) 
+        const IntType ticks = timestep.advance(focus);
+        for(IntType tick = 0; tick < ticks; ++tick)
         {
-            game.gameLoop();
-            if(Game::editorCheatKey())
+            const bool liveInput = !replaying;
+            Input::State input;
+            {
+                FixedStep::TickTimer timer(timestep);
+                input = recorder.poll();
+                game.gameLoop(input);
+                audio.update(game);
+            }
+
+            if(replaying && replay.done())
+            {
+                const Replay::Summary result = Replay::Summary::Capture(game, replay.getTicks());
+                std::cout << "Replay: " << (result.matches(replay.getExpected()) ? "OK" : "MISMATCH") 
+                          << " (frame " << result.frame << ", deaths " << result.deaths 
+                          << ", coins " << result.coins << ")\n";
+                recorder.setSource(live);
+                replaying = false;
+
+                // Presses made during the replay are stale
+                tracker.snapshot();
+            }
+
+            // Editing levels mid replay would change the outcome
+            if(input.get(Input::Button::Editor) && !replaying)
             {
-                game.overworldMusic.setPitch(0.8);
+                audio.setEditor(true);
                 game.setCheater();
-                game.loadWorld(LevelBuilder::Loop(app, game.getLevel(), game.getCameraX()));
-                while(sf::Keyboard::isKeyPressed(sf::Keyboard::Escape));
-                game.overworldMusic.setPitch(1);
+                const IntType editedLevel = LevelBuilder::Loop(app, renderer, tracker, game.getLevel(), game.getCameraX(), game.getCameraY());
+                game.updateLevelHash();
+                game.loadWorld(editedLevel);
+                tracker.ignoreHeld(); // Escape would reset the game
+                audio.setEditor(false);
+
+                // Time in the editor isn't game time
+                timestep.reset();
+                break;
             }
+
+            // Presses that opened the editor aren't timed
+            if(liveInput) latency.read(live.getSnapshot());
         }
 
-        Graphics::pushRGBA(app, game.returnWorldPixels(focus));
+        // The world is drawn where the last tick left it, then slid back to
+        // where the camera is between ticks, with the player drawn on top
+        const Game::View view = game.getView(timestep.alpha(), focus);
+        renderer.pushRGBA(app, game.returnWorldPixels(focus, false), 
+                          float(game.getCameraX() - view.cameraX), float(game.getCameraY() - view.cameraY));
+        renderer.drawBlock(app, float(view.playerX - view.cameraX), float(view.playerY - view.cameraY), view.player);
+
+        hud.update(game, view.cameraX, view.cameraY);
+        hud.draw(app);
 
-        TextTimes::UpdateHash(game, version);
-        TextTimes::UpdateLeaderboard(game, leaderboard);
-        TextTimes::UpdateTimer(game, timer);
-        app.draw(leaderboard);
-        app.draw(timer);
-        app.draw(version);
+        overlay.update();
+        overlay.draw(app);
         
-        app.display();
+        {
+            PROFILE_SCOPE("display");
+            renderer.display(app);
+        }
+        latency.displayed();
+        PROFILE_FRAME();
+    }
+
+    timestep.report(std::clog);
+    latency.report(std::clog);
+
+    if(Profiler::ENABLED)
+    {
+        Profiler::Recorder::Get().report(std::clog);
+
+        std::ofstream trace(profileFile);
+        if(!profileFile.empty() && trace.good()) Profiler::Recorder::Get().writeTrace(trace);
+        else if(!profileFile.empty()) std::cerr << "Could not write profile " << profileFile << '\n';
     }
 
+    if(!recordFile.empty() && !recorder.save(recordFile, game))
+        std::cerr << "Could not write replay " << recordFile << '\n';
+
     return EXIT_SUCCESS;
 }
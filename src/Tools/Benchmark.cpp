@@ -0,0 +1,515 @@
+#include "../Headers/Constants.h"
+#include "../Headers/Game.h"
+#include "../Headers/World.h"
+#include "../Headers/LevelIndex.h"
+#include "../Headers/LevelBuilder.h"
+#include "../Headers/FrameContext.h"
+#include "../Headers/Input.h"
+
+#include <algorithm> // Median
+#include <cstring> // Argument parsing
+#include <filesystem> // Scratch level folder
+#include <functional> // Benchmarks
+#include <iostream> // Results
+#include <map> // Results by name
+#include <vector> // Samples
+
+namespace fs = std::filesystem;
+
+static constexpr double SAMPLE_SECONDS = 0.1; // Each sample runs at least this long
+static constexpr IntType SAMPLES = 5; // The median one is kept
+static constexpr double DEFAULT_THRESHOLD = 10; // Percent slower that counts as a regression
+static constexpr double NOT_CHECKED = -1; // Threshold of benchmarks too noisy to fail on
+static constexpr std::uintmax_t GAME_TICKS = 2000; // Ticks before a level is started again
+static const std::string DEFAULT_BASELINE = "./Benchmarks/baseline.json"; // Where --update-baseline writes, not checked in
+
+// Benchmarks that vary more from run to run get more room, by name prefix.
+// Anything not here uses DEFAULT_THRESHOLD or --threshold.
+static const std::pair<const char*, double> THRESHOLDS[] = {
+    {"levelHash_", NOT_CHECKED}, // Asks the disk about every file
+    {"load_", 25}, // Reads files, even if they're cached
+    {"world_tall_view", 25},
+};
+
+// Level numbers the loader benchmarks write, past any real level
+static constexpr IntType HEIGHT_LEVEL = MAX_LEVEL_COUNT - 6;
+static constexpr IntType LENGTH_LEVEL = MAX_LEVEL_COUNT - 5;
+static constexpr IntType TALL_LEVEL = MAX_LEVEL_COUNT - 4;
+static constexpr IntType V1_LEVEL = MAX_LEVEL_COUNT - 3;
+static constexpr IntType SHORT_LEVEL = MAX_LEVEL_COUNT - 2;
+static constexpr IntType BAD_LEVEL = MAX_LEVEL_COUNT - 1;
+
+using Results = std::map<std::string, double>; // Nanoseconds per operation
+
+// Stops the compiler from throwing away work whose result isn't used
+static volatile std::uintmax_t Sink = 0;
+
+static void PrintUsage(const char* name)
+{
+    std::cerr << "Usage: " << name << " [--out FILE] [--baseline FILE] [--update-baseline]\n"
+              << "       " << std::string(std::strlen(name), ' ') << " [--threshold PERCENT] [--filter TEXT]\n";
+}
+
+/*******************/
+/***** TIMING ******/
+/*******************/
+
+// Runs body(count) in growing batches until a sample takes SAMPLE_SECONDS,
+// body has to do count operations. Returns the median nanoseconds per operation.
+static double Measure(const std::function<void(std::uintmax_t)>& body)
+{
+    std::uintmax_t count = 1;
+    std::vector<double> samples;
+    while(IntType(samples.size()) < SAMPLES)
+    {
+        const auto start = CHRONO_CLOCK::now();
+        body(count);
+        const double seconds = std::chrono::duration<double>(CHRONO_CLOCK::now() - start).count();
+
+        if(seconds < SAMPLE_SECONDS) count *= 2;
+        else samples.push_back(seconds * 1e9 / count);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+/***************************/
+/***** LEVEL FIXTURES ******/
+/***************************/
+
+// A level written the old way, every block as a byte after a 12 byte header.
+// Short levels stop half way through their blocks. The header doesn't have
+// to agree with the world, so the blocks can be read at the wrong height.
+static bool WriteV1(IntType lvl, const World& world, const Loader::HeaderData& header, bool complete)
+{
+    std::ofstream file(Loader::LevelPath(lvl), std::ios::binary);
+    file.write(header.getHeaderData(), sizeof(header));
+
+    const RawIntType columns = complete ? world.getLength() : world.getLength() / 2;
+    std::vector<char> column(world.getHeight());
+    for(RawIntType x = 0; x < columns; ++x)
+    {
+        for(RawIntType y = 0; y < world.getHeight(); ++y) column[y] = char(world.get(x, y));
+        file.write(column.data(), column.size());
+    }
+    return file.good();
+}
+
+// A copy of a level whose header says it's a chunk longer than it is
+static bool WriteLongHeader(IntType lvl, IntType from)
+{
+    std::error_code error;
+    fs::copy_file(Loader::LevelPath(from), Loader::LevelPath(lvl), fs::copy_options::overwrite_existing, error);
+    if(error) return false;
+
+    std::fstream file(Loader::LevelPath(lvl), std::ios::binary | std::ios::in | std::ios::out);
+    Loader::HeaderDataV2 header;
+    file.read(header.getHeaderData(), sizeof(header));
+    if(!file || header.getVersion() != Loader::LEVEL_VERSION) return false;
+
+    const Loader::HeaderDataV2 longer(header.getHeight(), header.getLength() + CHUNK_WIDTH, 
+                                      header.getCoins(), header.getChecksum());
+    file.seekp(0);
+    file.write(longer.getHeaderData(), sizeof(longer));
+    return file.good();
+}
+
+/**********************/
+/***** BENCHMARKS *****/
+/**********************/
+
+class Suite
+{
+public:
+    explicit Suite(const std::string& inFilter) : filter(inFilter) {}
+
+    void run(const std::string& name, const std::function<void(std::uintmax_t)>& body)
+    {
+        if(!matches(name)) return;
+
+        results[name] = Measure(body);
+        std::cout << name << ": " << results[name] << "ns\n";
+    }
+
+    // For benchmarks that also check something, the run fails at the end
+    void fail(const std::string& message)
+    {
+        std::cerr << "FAILED " << message << '\n';
+        failed = true;
+    }
+
+    bool matches(const std::string& name) const { return filter.empty() || name.find(filter) != std::string::npos; }
+    const Results& getResults() const { return results; }
+    bool hasFailed() const { return failed; }
+
+private:
+    std::string filter;
+    Results results;
+    bool failed = false;
+};
+
+static void RenderBenchmarks(Suite& suite)
+{
+    Game game;
+    game.loadWorld(START_LEVEL);
+
+    // Animated textures are what change from frame to frame
+    suite.run("render", [&](std::uintmax_t count)
+    {
+        for(std::uintmax_t i = 0; i < count; ++i)
+        {
+            FrameContext::Capture();
+            Sink = Sink + game.returnWorldPixels(true)[0];
+        }
+    });
+
+    suite.run("render_full", [&](std::uintmax_t count)
+    {
+        for(std::uintmax_t i = 0; i < count; ++i)
+        {
+            game.invalidateRender();
+            Sink = Sink + game.returnWorldPixels(true)[0];
+        }
+    });
+
+    suite.run("render_unfocused", [&](std::uintmax_t count)
+    {
+        for(std::uintmax_t i = 0; i < count; ++i)
+        {
+            FrameContext::Capture();
+            Sink = Sink + game.returnWorldPixels(false)[0];
+        }
+    });
+
+    // Fill the screen with smog so the player is standing in it
+    for(IntType x = 0; x < GAME_WIDTH; ++x)
+        for(IntType y = 0; y < IntType(GAME_HEIGHT); ++y)
+            game.getWorldRef(x, y) = GameType::Smog;
+
+    suite.run("render_smog", [&](std::uintmax_t count)
+    {
+        for(std::uintmax_t i = 0; i < count; ++i)
+        {
+            FrameContext::Capture();
+            Sink = Sink + game.returnWorldPixels(true)[0];
+        }
+    });
+
+    World world;
+    LevelBuilder::LoadWorld(world, START_LEVEL);
+    Byte buffer[GAME_HEIGHT][GAME_WIDTH][4];
+    suite.run("editor_updateBuffer", [&](std::uintmax_t count)
+    {
+        for(std::uintmax_t i = 0; i < count; ++i)
+        {
+            FrameContext::Capture();
+            LevelBuilder::updateBuffer(buffer, world, 0, 0, GameType::Ground, sf::Vector2i(GAME_WIDTH/2, GAME_HEIGHT/2));
+            Sink = Sink + buffer[0][0][0];
+        }
+    });
+}
+
+static void LoaderBenchmarks(Suite& suite)
+{
+    World source;
+    LevelBuilder::LoadWorld(source, START_LEVEL);
+    const RawIntType height = source.getHeight(), length = source.getLength();
+    if(!WriteV1(V1_LEVEL, source, Loader::HeaderData(MAGIC_NUMBER, height, length), true)
+    || !WriteV1(SHORT_LEVEL, source, Loader::HeaderData(MAGIC_NUMBER, height, length), false)
+    || !WriteV1(BAD_LEVEL, source, Loader::HeaderData(~MAGIC_NUMBER, height, length), true)
+    || !WriteV1(HEIGHT_LEVEL, source, Loader::HeaderData(MAGIC_NUMBER, height + 1, length), true)
+    || !WriteLongHeader(LENGTH_LEVEL, START_LEVEL))
+    {
+        std::cerr << "Could not write test levels, skipping loader benchmarks\n";
+        return;
+    }
+
+    // Open a level and read every chunk of it
+    const auto load = [](IntType lvl)
+    {
+        return [lvl](std::uintmax_t count)
+        {
+            for(std::uintmax_t i = 0; i < count; ++i)
+            {
+                World world;
+                if(world.load(lvl)) world.prefetch(0, world.getLength());
+                Sink = Sink + world.getResidentBytes();
+            }
+        };
+    };
+
+    suite.run("load_v2", load(START_LEVEL));
+    suite.run("load_v1", load(V1_LEVEL));
+    suite.run("load_v1_short", load(SHORT_LEVEL));
+    suite.run("load_bad_header", load(BAD_LEVEL));
+    suite.run("load_v1_wrong_height", load(HEIGHT_LEVEL));
+    suite.run("load_v2_wrong_length", load(LENGTH_LEVEL));
+
+    // The length is part of the checksum, so this one can't open
+    World longer;
+    if(suite.matches("load_v2_wrong_length") && longer.load(LENGTH_LEVEL))
+        suite.fail("load_v2_wrong_length opened a level whose header doesn't match its chunks");
+
+    for(IntType lvl : {V1_LEVEL, SHORT_LEVEL, BAD_LEVEL, HEIGHT_LEVEL, LENGTH_LEVEL})
+        fs::remove(Loader::LevelPath(lvl));
+
+    // Nothing changed, so only the file sizes and times are checked
+    LevelIndex index;
+    index.refresh();
+    suite.run("levelHash_unchanged", [&](std::uintmax_t count)
+    {
+        for(std::uintmax_t i = 0; i < count; ++i)
+        {
+            index.refresh();
+            Sink = Sink + index.getHash();
+        }
+    });
+
+    suite.run("levelHash_cold", [&](std::uintmax_t count)
+    {
+        for(std::uintmax_t i = 0; i < count; ++i)
+        {
+            LevelIndex fresh;
+            fresh.refresh();
+            Sink = Sink + fresh.getHash();
+        }
+    });
+}
+
+// A level as tall as levels can be, where two chunks are more than the
+// World's memory budget. Looking around the view shouldn't read anything
+// again once it's in memory.
+static void TallLevelBenchmarks(Suite& suite)
+{
+    if(!suite.matches("world_tall_view")) return;
+
+    Loader::LevelData tall;
+    tall.length = 4 * CHUNK_WIDTH;
+    tall.height = MAX_WORLD_HEIGHT;
+    tall.cells.resize(std::size_t(tall.length) * tall.height);
+    for(std::size_t i = 0; i < tall.cells.size(); ++i)
+        tall.cells[i] = (i % tall.height) % 7 == 0 ? GameType::Ground : GameType::Sky;
+
+    World world;
+    if(!Loader::SaveLevel(Loader::LevelPath(TALL_LEVEL), tall) || !world.load(TALL_LEVEL))
+    {
+        std::cerr << "Could not write the tall level, skipping it\n";
+        return;
+    }
+
+    // Where the game would have the camera, half way across and down
+    const IntType cameraX = CHUNK_WIDTH + CHUNK_WIDTH / 2, cameraY = tall.height / 2;
+    std::uintmax_t reads = 0;
+    suite.run("world_tall_view", [&](std::uintmax_t count)
+    {
+        for(std::uintmax_t i = 0; i < count; ++i)
+        {
+            world.prefetch(cameraX - CHUNK_WIDTH, cameraX + GAME_WIDTH + CHUNK_WIDTH);
+            if(reads == 0) reads = world.getChunkReads();
+
+            std::uintmax_t sum = 0;
+            for(IntType x = 0; x < GAME_WIDTH; ++x)
+                for(IntType y = 0; y < IntType(GAME_HEIGHT); ++y)
+                    sum += IntType(world.get(cameraX + x, cameraY + y));
+            Sink = Sink + sum;
+        }
+    });
+
+    if(world.getChunkReads() != reads)
+        suite.fail("world_tall_view read chunks " + std::to_string(world.getChunkReads() - reads) + " more times after the first view");
+
+    fs::remove(Loader::LevelPath(TALL_LEVEL));
+}
+
+static void MathBenchmarks(Suite& suite)
+{
+    suite.run("RANDOMIZE", [](std::uintmax_t count)
+    {
+        std::uintmax_t sum = 0;
+        for(std::uintmax_t i = 0; i < count; ++i) sum += RANDOMIZE(IntType(i));
+        Sink = Sink + sum;
+    });
+
+    suite.run("GetTypeData", [](std::uintmax_t count)
+    {
+        std::uintmax_t sum = 0;
+        for(std::uintmax_t i = 0; i < count; ++i)
+            sum += Game::GetTypeData(Game::GameTypeList[i % GameTypeCount].type).propertys;
+        Sink = Sink + sum;
+    });
+}
+
+// Nanoseconds per tick of each level, with a bot pressing random keys
+static void GameBenchmarks(Suite& suite)
+{
+    Game game;
+    for(IntType lvl = 0; lvl < MAX_LEVEL_COUNT; ++lvl)
+    {
+        if(!fs::exists(Loader::LevelPath(lvl))) continue;
+
+        suite.run("gameLoop_L" + std::to_string(lvl), [&](std::uintmax_t count)
+        {
+            Input::Random bot(lvl);
+            for(std::uintmax_t tick = 0; tick < count; ++tick)
+            {
+                // Back to the start now and then, so every run sees the same part of the level
+                if(tick % GAME_TICKS == 0) game.loadWorld(lvl);
+
+                FrameContext::Capture();
+                game.gameLoop(bot.poll());
+            }
+            Sink = Sink + game.getFrame();
+        });
+    }
+}
+
+/*******************/
+/***** RESULTS *****/
+/*******************/
+
+static bool WriteResults(const std::string& fileName, const Results& results)
+{
+    std::ofstream file(fileName);
+    file << "{\n  \"unit\": \"ns\",\n  \"results\": {\n";
+    for(auto it = results.begin(); it != results.end(); ++it)
+    {
+        file << "    \"" << it->first << "\": " << it->second
+             << (std::next(it) == results.end() ? "\n" : ",\n");
+    }
+    file << "  }\n}\n";
+    return file.good();
+}
+
+// Reads the "name": number lines WriteResults() writes
+static bool ReadResults(const std::string& fileName, Results& results)
+{
+    std::ifstream file(fileName);
+    if(!file.good()) return false;
+
+    std::string line;
+    while(std::getline(file, line))
+    {
+        const std::size_t open = line.find('"');
+        const std::size_t close = line.find('"', open + 1);
+        const std::size_t colon = line.find(':', close);
+        if(open == std::string::npos || close == std::string::npos || colon == std::string::npos) continue;
+
+        const std::string name = line.substr(open + 1, close - open - 1);
+        try { results[name] = std::stod(line.substr(colon + 1)); }
+        catch(const std::exception&) {}
+    }
+    return true;
+}
+
+// Percent slower this benchmark is allowed to get
+static double Threshold(const std::string& name, double fallback)
+{
+    for(const auto& entry : THRESHOLDS)
+        if(name.compare(0, std::strlen(entry.first), entry.first) == 0) return entry.second;
+    return fallback;
+}
+
+// True if nothing got slower than its threshold allows
+static bool Compare(const Results& baseline, const Results& results, double threshold)
+{
+    bool passed = true;
+    for(const auto& result : results)
+    {
+        const auto old = baseline.find(result.first);
+        if(old == baseline.end() || old->second <= 0) continue;
+
+        const double allowed = Threshold(result.first, threshold);
+        const double change = (result.second / old->second - 1) * 100;
+        const bool regressed = allowed != NOT_CHECKED && change > allowed;
+        passed = passed && !regressed;
+
+        std::cout << (regressed ? "SLOWER " : "       ") << result.first << ": "
+                  << old->second << "ns -> " << result.second << "ns ("
+                  << (change >= 0 ? "+" : "") << change << "%"
+                  << (allowed == NOT_CHECKED ? ", not checked)\n" : ")\n");
+    }
+    return passed;
+}
+
+// Times the game's hot paths, and checks them against an earlier run
+int main(int argc, char** argv)
+{
+    std::string outFile = "benchmark.json", baselineFile, filter;
+    double threshold = DEFAULT_THRESHOLD;
+    bool update = false;
+
+    for(IntType i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) outFile = argv[++i];
+        else if(std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baselineFile = argv[++i];
+        else if(std::strcmp(argv[i], "--update-baseline") == 0) update = true;
+        else if(std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) threshold = std::stod(argv[++i]);
+        else if(std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Rewriting the baseline, so there's nothing to compare against
+    const std::string updateFile = update ? (baselineFile.empty() ? DEFAULT_BASELINE : baselineFile) : std::string();
+    if(update) baselineFile.clear();
+
+    Results baseline;
+    if(!baselineFile.empty() && !ReadResults(baselineFile, baseline))
+    {
+        std::cerr << "Could not read baseline " << baselineFile << ", make one with --update-baseline\n";
+        return EXIT_FAILURE;
+    }
+
+    // The loader benchmarks write levels, so everything runs on a copy
+    const fs::path home = fs::current_path();
+    const fs::path scratch = fs::temp_directory_path() / "UpsideDownBenchmark";
+    std::error_code error;
+    fs::remove_all(scratch, error);
+    fs::create_directories(scratch / LEVEL_FOLDER, error);
+    if(fs::exists(LEVEL_FOLDER))
+        fs::copy(LEVEL_FOLDER, scratch / LEVEL_FOLDER, fs::copy_options::recursive, error);
+    if(error)
+    {
+        std::cerr << "Could not copy levels to " << scratch << '\n';
+        return EXIT_FAILURE;
+    }
+    fs::current_path(scratch);
+
+    // Counted frames, so every run animates the same way
+    SyntheticFrameClock clock;
+    FrameContext::SetClock(clock);
+
+    Suite suite(filter);
+    RenderBenchmarks(suite);
+    LoaderBenchmarks(suite);
+    TallLevelBenchmarks(suite);
+    MathBenchmarks(suite);
+    GameBenchmarks(suite);
+
+    fs::current_path(home);
+    fs::remove_all(scratch, error);
+
+    // Benchmarks that were filtered out keep their old baseline
+    Results updated;
+    if(update) ReadResults(updateFile, updated);
+    if(update && fs::path(updateFile).has_parent_path()) fs::create_directories(fs::path(updateFile).parent_path(), error);
+    for(const auto& result : suite.getResults()) updated[result.first] = result.second;
+
+    if(!WriteResults(outFile, suite.getResults()) || (update && !WriteResults(updateFile, updated)))
+    {
+        std::cerr << "Could not write " << (update ? outFile + " or " + updateFile : outFile) << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if(!baselineFile.empty() && !Compare(baseline, suite.getResults(), threshold))
+    {
+        std::cout << "Slower than " << baselineFile << " allows\n";
+        return EXIT_FAILURE;
+    }
+
+    return suite.hasFailed() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+#include "../Headers/Constants.h"
+#include "../Headers/Game.h"
+#include "../Headers/FrameContext.h"
+#include "../Headers/Input.h"
+#include "../Headers/Replay.h"
+
+#include <iostream> // Results
+#include <cstring> // Argument parsing
+
+static void PrintUsage(const char* name)
+{
+    std::cerr << "Usage: " << name << " [--ticks N] [--seed N] [--idle] [--record FILE]\n"
+              << "       " << name << " --replay FILE [--ignore-hash]\n";
+}
+
+// Runs the simulation without a window, audio or a person at the controls
+int main(int argc, char** argv)
+{
+    std::uintmax_t ticks = 1000000;
+    IntType seed = 1;
+    bool idle = false, ignoreHash = false;
+    std::string recordFile, replayFile;
+
+    for(IntType i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) ticks = std::stoull(argv[++i]);
+        else if(std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = std::stoi(argv[++i]);
+        else if(std::strcmp(argv[i], "--idle") == 0) idle = true;
+        else if(std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordFile = argv[++i];
+        else if(std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replayFile = argv[++i];
+        else if(std::strcmp(argv[i], "--ignore-hash") == 0) ignoreHash = true;
+        else 
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Game game;
+    Input::Random bot(seed);
+    Input::Idle nobody;
+    Replay::Player replay;
+    Replay::Summary expected;
+    Replay::Recorder recorder(idle ? static_cast<Input::Source&>(nobody) : bot);
+    recorder.begin(game);
+
+    if(!replayFile.empty())
+    {
+        if(!replay.load(replayFile))
+        {
+            std::cerr << "Could not read replay " << replayFile << '\n';
+            return EXIT_FAILURE;
+        }
+
+        expected = replay.getExpected();
+        ticks = expected.ticks;
+
+        // Other levels can't play out the same way
+        if(expected.hash != game.getLevelHash())
+        {
+            std::cerr << "Replay was recorded on different levels (hash " << std::hex << expected.hash
+                      << ", these are " << game.getLevelHash() << std::dec << ")\n";
+            if(!ignoreHash)
+            {
+                std::cerr << "Use --ignore-hash to play it anyway\n";
+                return EXIT_FAILURE;
+            }
+            expected.hash = game.getLevelHash();
+        }
+    }
+
+    Input::Source& controls = replayFile.empty() 
+        ? static_cast<Input::Source&>(recorder) : replay;
+
+    // Count frames instead of reading the wall clock so
+    // unknown blocks do the same thing every run
+    SyntheticFrameClock clock;
+    FrameContext::SetClock(clock);
+
+    // Fast forward, no frame limit
+    const auto start = CHRONO_CLOCK::now();
+    for(std::uintmax_t tick = 0; tick < ticks; ++tick)
+    {
+        FrameContext::Capture();
+        game.gameLoop(controls.poll());
+    }
+    const auto end = CHRONO_CLOCK::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Ticks: " << ticks << '\n'
+              << "Seconds: " << seconds << '\n'
+              << "Ticks Per Second: " << (seconds > 0 ? ticks / seconds : 0) << '\n'
+              << "Level: " << game.getLevel() << '\n'
+              << "Frame: " << game.getFrame() << '\n'
+              << "Deaths: " << game.getDeaths() << '\n'
+              << "Coins: " << game.getCoins() << " / " << game.getMaxCoins() << '\n';
+
+    if(!recordFile.empty() && !recorder.save(recordFile, game))
+    {
+        std::cerr << "Could not write replay " << recordFile << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if(!replayFile.empty())
+    {
+        const Replay::Summary result = Replay::Summary::Capture(game, replay.getTicks());
+        if(!result.matches(expected))
+        {
+            std::cout << "Replay: MISMATCH (expected frame " << expected.frame 
+                      << ", deaths " << expected.deaths 
+                      << ", coins " << expected.coins << ")\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << "Replay: OK\n";
+    }
+
+    return EXIT_SUCCESS;
+}
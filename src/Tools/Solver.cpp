@@ -0,0 +1,359 @@
+#include "../Headers/Constants.h"
+#include "../Headers/Game.h"
+#include "../Headers/FrameContext.h"
+#include "../Headers/Input.h"
+
+#include <atomic> // Handing out levels
+#include <bitset> // Counting coins
+#include <cstring> // Argument parsing
+#include <deque> // Search frontier
+#include <filesystem> // Finding levels
+#include <iostream> // Results
+#include <thread> // One search per level at a time
+#include <vector> // Coins and results
+
+static constexpr IntType MAX_COINS = 64; // Levels with more can't be solved
+static constexpr std::size_t DEFAULT_MAX_STATES = 1 << 24;
+
+static void PrintUsage(const char* name)
+{
+    std::cerr << "Usage: " << name << " [--level N] [--threads N] [--max-states N]\n";
+}
+
+/************************/
+/***** VISITED SET ******/
+/************************/
+
+// Open addressing table of every state already searched, keyed by the player
+// and the coins they've taken. Only the lowest trap position is kept for each,
+// a state reached again with the trap further back is still worth searching.
+class VisitedSet
+{
+public:
+    VisitedSet() : slots(1 << 16) {}
+
+    // True if this is new, or closer to the start of the trap than before
+    bool visit(std::uint64_t player, std::uint64_t coins, IntType trapX)
+    {
+        if(2 * (count + 1) > slots.size()) grow();
+
+        Slot& slot = find(player, coins);
+        if(slot.used && slot.trapX <= trapX) return false;
+
+        if(!slot.used) ++count;
+        slot = {player, coins, trapX, true};
+        return true;
+    }
+
+    std::size_t size() const { return count; }
+
+private:
+    struct Slot
+    {
+        std::uint64_t player = 0, coins = 0;
+        IntType trapX = 0;
+        bool used = false;
+    };
+
+    static std::size_t Hash(std::uint64_t player, std::uint64_t coins)
+    {
+        // splitmix64 finalizer
+        std::uint64_t h = player ^ (coins * 0x9e3779b97f4a7c15ull);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        return std::size_t(h ^ (h >> 31));
+    }
+
+    Slot& find(std::uint64_t player, std::uint64_t coins)
+    {
+        const std::size_t mask = slots.size() - 1;
+        for(std::size_t i = Hash(player, coins) & mask;; i = (i + 1) & mask)
+        {
+            Slot& slot = slots[i];
+            if(!slot.used || (slot.player == player && slot.coins == coins)) return slot;
+        }
+    }
+
+    void grow()
+    {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        for(const Slot& slot : old)
+            if(slot.used) find(slot.player, slot.coins) = slot;
+    }
+
+    std::vector<Slot> slots;
+    std::size_t count = 0;
+};
+
+/******************/
+/***** SOLVER *****/
+/******************/
+
+struct Result
+{
+    IntType level = -1;
+    bool solved = false, gaveUp = false, tooManyCoins = false;
+    IntType par = 0; // Frames on the level timer
+    IntType coins = 0, maxCoins = 0; // Most taken on a run that finishes, and how many there are
+    std::size_t states = 0;
+    double seconds = 0;
+};
+
+// Everything a search step can press, left and right together go nowhere
+static const std::vector<Input::State> ACTIONS = []()
+{
+    std::vector<Input::State> actions;
+    for(InputType move : {Input::Button::None, Input::Button::Left, Input::Button::Right})
+    {
+        for(bool jump : {false, true})
+        {
+            Input::State action;
+            action.buttons = move;
+            action.set(Input::Button::Jump, jump);
+            actions.push_back(action);
+        }
+    }
+    return actions;
+}();
+
+// Drives the real gameLoop from saved states, so the search follows the
+// same rules as the game. Coins are put back the way each state left them
+// before every step, since taking one changes the level.
+//
+// In the game unknown blocks turn into a block picked from the clock, so on
+// levels that have them every step is tried once as each block they could be.
+// A level counts as solved if some run of picks finishes it.
+class Solver
+{
+public:
+    Solver(Game& inGame, std::size_t inMaxStates) : game(inGame), maxStates(inMaxStates)
+    {
+        FrameContext::SetClock(clock);
+    }
+
+    Result solve(IntType lvl)
+    {
+        const auto start = CHRONO_CLOCK::now();
+        Result result;
+        result.level = lvl;
+
+        if(game.loadWorld(lvl) != lvl) return result;
+        findCoins();
+        findRolls();
+        result.maxCoins = IntType(coins.size());
+
+        // Each coin is a bit of the state, one without a bit couldn't be put
+        // back, and taking it would change the level for every other branch
+        if(result.maxCoins > MAX_COINS)
+        {
+            result.tooManyCoins = true;
+            return result;
+        }
+
+        // 0-1 breadth first, a tick only costs a frame once the level timer is running
+        VisitedSet visited;
+        std::deque<Node> frontier{{game.getPlayerState(), 0, 0}};
+        while(!frontier.empty())
+        {
+            const Node node = frontier.front();
+            frontier.pop_front();
+
+            if(!visited.visit(Pack(node.state), node.coins, node.state.trapX)) continue;
+            if(visited.size() > maxStates) { result.gaveUp = true; break; }
+
+            const IntType cost = node.cost + (node.state.player.x > START_SIZE ? 1 : 0);
+            for(const Input::State& action : ACTIONS)
+            {
+                for(IntType roll : rolls)
+                {
+                    Node next;
+                    if(step(lvl, node, action, roll, next))
+                    {
+                        // The first finish is the fastest, keep going for coins
+                        if(!result.solved) result.par = cost;
+                        result.solved = true;
+                        result.coins = std::max(result.coins, IntType(std::bitset<MAX_COINS>(node.coins).count()));
+                        continue;
+                    }
+
+                    next.cost = cost;
+                    if(cost == node.cost) frontier.push_front(next);
+                    else frontier.push_back(next);
+                }
+            }
+        }
+
+        result.states = visited.size();
+        result.seconds = std::chrono::duration<double>(CHRONO_CLOCK::now() - start).count();
+        return result;
+    }
+
+private:
+    struct Node
+    {
+        Game::PlayerState state;
+        std::uint64_t coins; // Bit for each coin taken
+        IntType cost;
+    };
+
+    struct Coin
+    {
+        sf::Vector2<IntType> position;
+        GameType taken = GameType::Coin; // What the game leaves behind
+    };
+
+    // Position, gravity, jump and bounce, and rawFrame parity for slow blocks
+    static std::uint64_t Pack(const Game::PlayerState& s)
+    {
+        return (std::uint64_t(RawIntType(s.player.x + 1) & 0xffffff) << 24)
+             | (std::uint64_t(RawIntType(s.player.y + 1) & 0xffff) << 8)
+             | (std::uint64_t(s.gravity == Game::GravityType::Up) << 3)
+             | (std::uint64_t(s.canJump) << 2)
+             | (std::uint64_t(s.canBounce) << 1)
+             | std::uint64_t(s.rawFrame & 1);
+    }
+
+    void findCoins()
+    {
+        coins.clear();
+        unknown = false;
+        const IntType length = game.getLevelLength(), height = game.getLevelHeight();
+        for(IntType x = 0; x < length; ++x)
+        {
+            for(IntType y = 0; y < height; ++y)
+            {
+                const GameType cell = game.getWorld(x, y);
+                if(cell == GameType::Coin) coins.push_back({{x, y}});
+                if(Game::GameTypeTable[cell].index == Game::UNKNOWN_TYPE) unknown = true;
+            }
+        }
+    }
+
+    // A frame that makes unknown blocks act as each type, or any frame if there are none
+    void findRolls()
+    {
+        rolls.assign(1, 0);
+        if(!unknown) return;
+
+        rolls.assign(GameTypeCount, -1);
+        IntType found = 0;
+        for(IntType frame = 0; found < GameTypeCount; ++frame)
+        {
+            IntType& roll = rolls[RANDOMIZE(frame) % GameTypeCount];
+            if(roll < 0) { roll = frame; ++found; }
+        }
+    }
+
+    // True if the step reached the goal
+    bool step(IntType lvl, const Node& from, const Input::State& action, IntType roll, Node& to)
+    {
+        for(std::size_t i = 0; i < coins.size(); ++i)
+            game.getWorldRef(coins[i].position.x, coins[i].position.y) = (from.coins >> i & 1) ? coins[i].taken : GameType::Coin;
+
+        // Picks what unknown blocks are for this step
+        clock = SyntheticFrameClock(roll);
+        FrameContext::Capture();
+
+        game.setPlayerState(from.state);
+        game.gameLoop(action);
+
+        // The goal loads the next level
+        if(game.getSoundEvents() & Game::SoundEvents::PlayWin)
+        {
+            game.loadWorld(lvl);
+            return true;
+        }
+
+        to.state = game.getPlayerState();
+        to.coins = 0;
+        for(std::size_t i = 0; i < coins.size(); ++i)
+        {
+            const GameType cell = game.getWorld(coins[i].position.x, coins[i].position.y);
+            if(cell == GameType::Coin) continue;
+
+            if(!(from.coins >> i & 1)) coins[i].taken = cell;
+            to.coins |= std::uint64_t(1) << i;
+        }
+        return false;
+    }
+
+    Game& game;
+    std::size_t maxStates;
+    std::vector<Coin> coins;
+    bool unknown = false; // The level has unknown blocks
+    std::vector<IntType> rolls; // Frames each step is tried with
+    SyntheticFrameClock clock; // This thread's, set for each step
+};
+
+// Proves every level can be finished before the trap catches up,
+// and works out the fastest time and most coins for each
+int main(int argc, char** argv)
+{
+    IntType only = -1;
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t maxStates = DEFAULT_MAX_STATES;
+
+    for(IntType i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--level") == 0 && i + 1 < argc) only = std::stoi(argv[++i]);
+        else if(std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = std::max(1, std::stoi(argv[++i]));
+        else if(std::strcmp(argv[i], "--max-states") == 0 && i + 1 < argc) maxStates = std::stoull(argv[++i]);
+        else
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Level 0 is the ending, there's nothing to finish
+    std::vector<IntType> levels;
+    for(IntType lvl = START_LEVEL; lvl < MAX_LEVEL_COUNT; ++lvl)
+        if((only < 0 || only == lvl) && std::filesystem::exists(Loader::LevelPath(lvl))) levels.push_back(lvl);
+
+    if(levels.empty())
+    {
+        std::cerr << "No levels found in " << LEVEL_FOLDER << '\n';
+        return EXIT_FAILURE;
+    }
+
+    // Each thread plays its own copy of the game
+    std::vector<Result> results(levels.size());
+    std::atomic<std::size_t> next(0);
+    const auto worker = [&]()
+    {
+        Game game;
+        Solver solver(game, maxStates);
+        for(std::size_t i = next++; i < levels.size(); i = next++)
+            results[i] = solver.solve(levels[i]);
+    };
+
+    const auto start = CHRONO_CLOCK::now();
+    std::vector<std::thread> pool;
+    for(std::size_t i = 1; i < std::min(threads, levels.size()); ++i) pool.emplace_back(worker);
+    worker();
+    for(std::thread& thread : pool) thread.join();
+    const double seconds = std::chrono::duration<double>(CHRONO_CLOCK::now() - start).count();
+
+    bool allSolved = true;
+    for(const Result& result : results)
+    {
+        std::cout << "Level " << result.level << ": ";
+        if(result.solved)
+        {
+            std::cout << "par " << result.par << " frames (" << double(result.par) / GAME_FPS << "s), "
+                      << "coins " << result.coins << " / " << result.maxCoins;
+            if(result.gaveUp) std::cout << " or more";
+        }
+        else if(result.tooManyCoins) std::cout << "TOO MANY COINS (" << result.maxCoins << ", at most " << MAX_COINS << " can be solved)";
+        else if(result.gaveUp) std::cout << "GAVE UP";
+        else std::cout << "NO PATH TO GOAL";
+
+        if(!result.tooManyCoins) std::cout << ", " << result.states << " states in " << result.seconds << 's';
+        std::cout << '\n';
+        allSolved = allSolved && result.solved;
+    }
+    std::cout << "Total: " << seconds << "s\n";
+
+    return allSolved ? EXIT_SUCCESS : EXIT_FAILURE;
+}
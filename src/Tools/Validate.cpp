@@ -0,0 +1,253 @@
+#include "../Headers/Constants.h"
+#include "../Headers/Game.h"
+#include "../Headers/FileLoader.h"
+#include "../Headers/LevelIndex.h"
+
+#include <atomic> // Handing out levels
+#include <cstring> // Argument parsing
+#include <filesystem> // Finding levels
+#include <fstream> // Report file
+#include <iostream> // Report
+#include <sstream> // Building messages
+#include <thread> // Checking levels in parallel
+#include <vector> // Levels and problems
+
+static void PrintUsage(const char* name)
+{
+    std::cerr << "Usage: " << name << " [--out FILE] [--threads N]\n";
+}
+
+/*******************/
+/***** CHECKS ******/
+/*******************/
+
+struct Problem
+{
+    bool error; // Warnings are allowed through
+    std::string message;
+};
+
+struct Report
+{
+    IntType level = 0;
+    RawIntType version = 0, length = 0, height = 0, coins = 0;
+    std::vector<Problem> problems;
+
+    bool hasErrors() const
+    {
+        for(const Problem& problem : problems) if(problem.error) return true;
+        return false;
+    }
+
+    void add(bool error, const std::string& message)
+    {
+        problems.push_back({error, message});
+    }
+};
+
+// Position in the level as text
+static std::string At(RawIntType x, RawIntType y)
+{
+    return "(" + std::to_string(x) + ", " + std::to_string(y) + ")";
+}
+
+// What the level editor puts around the start: a trap border on the right
+// and bottom of the box in the top left, and nothing that kills the player
+// before they've left the start area
+static void CheckStart(const std::vector<GameType>& cells, RawIntType height, Report& report)
+{
+    const auto get = [&](IntType x, IntType y) { return cells[std::size_t(x) * height + y]; };
+    if(height <= 7 || IntType(report.length) <= START_SIZE) return;
+
+    for(IntType x = 0; x <= START_SIZE; ++x)
+    {
+        for(IntType y = 0; y <= 7; ++y)
+        {
+            if((x == START_SIZE || y == 7) && get(x, y) != GameType::Trap)
+            {
+                report.add(false, "Start box border is missing at " + At(x, y));
+                return;
+            }
+        }
+    }
+
+    for(IntType x = 0; x < START_SIZE; ++x)
+    {
+        for(IntType y = 8; y < IntType(height); ++y)
+        {
+            if(Game::GetTypeData(get(x, y)).getProp(Game::TypeProps::Trap))
+            {
+                report.add(true, "Trap in the start area at " + At(x, y));
+                return;
+            }
+        }
+    }
+
+    if(GAME_START_Y < IntType(height)
+    && Game::GetTypeData(get(GAME_START_X, GAME_START_Y)).getProp(Game::TypeProps::Solid))
+        report.add(true, "Player starts inside a solid block at " + At(GAME_START_X, GAME_START_Y));
+}
+
+// Reads every block of one level, the same way the game does
+static Report CheckLevel(IntType lvl, Loader::LevelFile& file)
+{
+    Report report;
+    report.level = lvl;
+
+    if(!file.open(lvl))
+    {
+        report.add(true, "Header is damaged, or isn't a level file");
+        return report;
+    }
+
+    report.version = file.getVersion();
+    report.length = file.getLength();
+    report.height = file.getHeight();
+
+    if(report.height < GAME_HEIGHT || IntType(report.length) < GAME_WIDTH)
+        report.add(true, "Smaller than the screen");
+    else if(report.height != GAME_HEIGHT || report.length != GAME_LENGTH)
+        report.add(false, "Not the size new levels are, " + std::to_string(GAME_LENGTH) + " x " + std::to_string(GAME_HEIGHT));
+
+    if(report.version < Loader::LEVEL_VERSION)
+        report.add(false, "Version " + std::to_string(report.version) + ", saving it in the editor will update it");
+
+    // Counted the way the level hash counts them
+    RawIntType checksum = 0;
+    file.summarize(checksum, report.coins);
+
+    // Whole level in memory, a column after another
+    std::vector<GameType> cells(std::size_t(file.getChunkCount()) * CHUNK_WIDTH * report.height);
+    RawIntType counted = 0, unknown = 0;
+    for(RawIntType i = 0; i < file.getChunkCount(); ++i)
+    {
+        GameType* chunk = &cells[std::size_t(i) * CHUNK_WIDTH * report.height];
+        if(!file.readChunk(i, chunk))
+            report.add(true, "Columns " + std::to_string(i * CHUNK_WIDTH) + " to "
+                + std::to_string(i * CHUNK_WIDTH + Loader::ChunkColumns(i, report.length) - 1) + " are damaged and will load as sky");
+
+        const std::size_t count = std::size_t(Loader::ChunkColumns(i, report.length)) * report.height;
+        for(std::size_t c = 0; c < count; ++c)
+        {
+            if(chunk[c] == GameType::Coin) ++counted;
+
+            // These change into a random block every frame
+            if(Game::GameTypeTable[chunk[c]].index != Game::UNKNOWN_TYPE) continue;
+            if(unknown++ == 0)
+            {
+                const std::size_t cell = std::size_t(i) * CHUNK_WIDTH * report.height + c;
+                std::ostringstream message;
+                message << "Unknown block 0x" << std::hex << IntType(chunk[c]) << std::dec
+                        << " at " << At(RawIntType(cell / report.height), RawIntType(cell % report.height));
+                report.add(false, message.str());
+            }
+        }
+    }
+
+    if(unknown > 1)
+        report.add(false, std::to_string(unknown) + " unknown blocks in total");
+
+    if(counted != report.coins)
+        report.add(true, "Header says " + std::to_string(report.coins) + " coins, the level has " + std::to_string(counted));
+
+    CheckStart(cells, report.height, report);
+    file.close();
+    return report;
+}
+
+/*******************/
+/***** REPORT ******/
+/*******************/
+
+static void WriteReport(std::ostream& out, const std::vector<Report>& reports, HashType hash, IntType totalCoins)
+{
+    out << "{\n  \"hash\": \"" << std::hex << hash << std::dec << "\",\n"
+        << "  \"coins\": " << totalCoins << ",\n"
+        << "  \"levels\": [";
+
+    for(std::size_t i = 0; i < reports.size(); ++i)
+    {
+        const Report& report = reports[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"level\": " << report.level
+            << ", \"version\": " << report.version
+            << ", \"length\": " << report.length
+            << ", \"height\": " << report.height
+            << ", \"coins\": " << report.coins
+            << ", \"ok\": " << (report.hasErrors() ? "false" : "true")
+            << ", \"problems\": [";
+
+        for(std::size_t p = 0; p < report.problems.size(); ++p)
+        {
+            const Problem& problem = report.problems[p];
+            out << (p == 0 ? "" : ", ") << "{\"error\": " << (problem.error ? "true" : "false")
+                << ", \"message\": \"" << problem.message << "\"}";
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// Checks every level file without playing them
+int main(int argc, char** argv)
+{
+    std::string outFile;
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for(IntType i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) outFile = argv[++i];
+        else if(std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = std::max(1, std::stoi(argv[++i]));
+        else
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<IntType> levels;
+    for(IntType lvl = 0; lvl < MAX_LEVEL_COUNT; ++lvl)
+        if(std::filesystem::exists(Loader::LevelPath(lvl))) levels.push_back(lvl);
+
+    // Each thread only writes the reports of the levels it takes
+    std::vector<Report> reports(levels.size());
+    std::atomic<std::size_t> next(0);
+    const auto worker = [&]()
+    {
+        Loader::LevelFile file;
+        for(std::size_t i = next++; i < levels.size(); i = next++)
+            reports[i] = CheckLevel(levels[i], file);
+    };
+
+    std::vector<std::thread> pool;
+    for(std::size_t i = 1; i < std::min(threads, levels.size()); ++i) pool.emplace_back(worker);
+    worker();
+    for(std::thread& thread : pool) thread.join();
+
+    // The same hash the game checks replays against
+    LevelIndex index;
+    index.refresh();
+
+    if(outFile.empty()) WriteReport(std::cout, reports, index.getHash(), index.getTotalCoins());
+    else
+    {
+        std::ofstream file(outFile);
+        WriteReport(file, reports, index.getHash(), index.getTotalCoins());
+        if(!file.good())
+        {
+            std::cerr << "Could not write " << outFile << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    bool passed = !levels.empty();
+    for(const Report& report : reports)
+    {
+        for(const Problem& problem : report.problems)
+            std::cerr << "Level " << report.level << (problem.error ? " error: " : " warning: ") << problem.message << '\n';
+        passed = passed && !report.hasErrors();
+    }
+
+    if(levels.empty()) std::cerr << "No levels found in " << LEVEL_FOLDER << '\n';
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}